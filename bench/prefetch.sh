@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+#
+# Time from 'je <label>' until the editor has its target open, with
+# and without prefetch, starting from a dropped page cache each run.
+# Needs root for /proc/sys/vm/drop_caches.
+#
+#   sudo bash bench/prefetch.sh <file or dir> [runs]
+#
+# The editor is a stand in that sleeps for EDITOR_STARTUP_MS (plugins,
+# config, ...) then reads the file or lists two levels of the dir,
+# which is roughly what a real editor does before its first paint.
+set -e
+
+target=$(realpath "${1:?usage: sudo bash bench/prefetch.sh <file or dir> [runs]}")
+runs=${2:-5}
+je=$(realpath "${JE:-./jump_edit}")
+startup_ms=${EDITOR_STARTUP_MS:-50}
+
+if [[ $EUID -ne 0 ]]; then
+	echo "bench/prefetch.sh: needs root to drop the page cache" >&2
+	exit 1
+fi
+
+# keep the benchmark label out of the user's database
+export XDG_DATA_HOME
+XDG_DATA_HOME="$(mktemp -d)"
+trap 'rm -rf "$XDG_DATA_HOME"' EXIT
+mkdir -p "$XDG_DATA_HOME/.local/share"
+
+editor="$XDG_DATA_HOME/editor"
+cat > "$editor" <<EDITOR
+#!/bin/sh
+sleep $(awk "BEGIN { print $startup_ms / 1000 }")
+if [ -d "\$1" ]; then find "\$1" -maxdepth 2 >/dev/null; else cat "\$1" >/dev/null; fi
+EDITOR
+chmod +x "$editor"
+
+"$je" default-editor "$editor" >/dev/null
+"$je" add bench "$target" >/dev/null
+
+# prints the milliseconds of one cold open
+run() {
+	sync
+	echo 3 > /proc/sys/vm/drop_caches
+
+	local start end script
+	start=$(date +%s%N)
+	script="$("$je" "$@" bench)"
+	(eval "$script") # the script cd's, keep ours
+	end=$(date +%s%N)
+
+	# let a prefetch child finish before the next drop
+	sleep 0.5
+
+	echo $(((end - start) / 1000000))
+}
+
+# modes alternate so drift on the machine hits both the same
+without=0
+with=0
+for ((i = 0; i < runs; i++)); do
+	if ((i % 2)); then
+		with=$((with + $(run)))
+		without=$((without + $(run --no-prefetch)))
+	else
+		without=$((without + $(run --no-prefetch)))
+		with=$((with + $(run)))
+	fi
+done
+without=$((without / runs))
+with=$((with / runs))
+
+echo "target .............. $target"
+echo "runs ................ $runs"
+echo "editor startup ...... ${startup_ms} ms"
+echo "without prefetch .... ${without} ms"
+echo "with prefetch ....... ${with} ms"
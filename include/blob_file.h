@@ -0,0 +1,18 @@
+#ifndef BLOB_FILE_H
+#define BLOB_FILE_H
+#include <stdlib.h> // size_t
+
+/*
+ * the compiled .je layers and the label index are both one
+ * blob that is written whole and read through mmap
+ */
+
+// maps path read only, fails if it is shorter than min_size
+void *BF_map(const char *path, size_t min_size, size_t *out_size); // use BF_unmap()
+
+void BF_unmap(void *map, size_t size);
+
+// replaces path with size bytes of buf atomically
+int BF_write(const char *path, const void *buf, size_t size);
+
+#endif
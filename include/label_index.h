@@ -0,0 +1,63 @@
+#ifndef LABEL_INDEX_H
+#define LABEL_INDEX_H
+#include <stdlib.h> // size_t
+#include <stdint.h>
+
+/*
+ * every personal label in sorted order so namespaces like
+ * "work/" can be listed or removed with a binary search and a
+ * walk over just the matching labels. Laid out as header,
+ * offsets sorted by label, then a '\0' terminated string table
+ */
+// the database file as it was when the index was written, a
+// database that no longer looks like this was changed behind it
+struct li_source{
+
+	int64_t mtime_sec;
+	int64_t mtime_nsec;
+	int64_t size;
+};
+
+struct li_header{
+
+	char magic[4];
+	uint32_t count;
+	struct li_source source;
+};
+
+struct li_index{
+
+	void *map;
+	size_t size;
+
+	uint32_t count;
+	struct li_source source;
+	const uint32_t *offsets;
+	const char *strings;
+};
+
+
+int LI_open(const char *path, struct li_index *out_index); // use LI_close()
+
+void LI_close(struct li_index *index);
+
+// first label that is not less than label
+size_t LI_lower_bound(struct li_index *index, const char *label);
+
+// pointer stays valid until LI_close
+const char *LI_get(struct li_index *index, size_t element);
+
+size_t LI_len(struct li_index *index);
+
+// labels must already be sorted, replaces the file atomically
+int LI_write(const char *path, const char **labels, size_t n_labels,
+		const struct li_source *source);
+
+// rewrites the file with label added or every label in [from, to) removed
+int LI_insert(const char *path, const char *label, const struct li_source *source);
+
+int LI_remove_range(const char *path, size_t from, size_t to, const struct li_source *source);
+
+int LI_same_source(const struct li_source *a, const struct li_source *b);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+#include <stdlib.h> // size_t
+
+#define PF_MAX_DEPTH 2              // directory levels walked below a target
+#define PF_MAX_ENTRIES 4096         // entries stat'd across all targets
+#define PF_MAX_BYTES (8 << 20)      // readahead asked for per file
+#define PF_BUDGET_MS 200            // the child gives up after this long
+
+
+// forks a detached child that pulls paths into the page and
+// dentry caches, returns as soon as the child is started
+void PF_spawn(const char **paths, size_t n_paths);
+
+#endif
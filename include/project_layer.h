@@ -0,0 +1,72 @@
+#ifndef PROJECT_LAYER_H
+#define PROJECT_LAYER_H
+#include <stdlib.h> // size_t
+#include <stdint.h>
+
+#define PL_FILE_NAME ".je"
+
+#if defined(__APPLE__)
+	#define PL_MTIME(st) ((st)->st_mtimespec)
+#else
+	#define PL_MTIME(st) ((st)->st_mtim)
+#endif
+
+/*
+ * a project's .je file compiled into one mmap-able blob:
+ * header, entries sorted by label, then a '\0' terminated
+ * string table the entries point into
+ */
+struct pl_header{
+
+	char magic[4];
+	uint32_t count;
+
+	// .je the blob was compiled from, recompiled if they change
+	int64_t src_mtime_sec;
+	int64_t src_mtime_nsec;
+	int64_t src_size;
+
+	uint32_t root; // string offset of the project root
+};
+
+struct pl_entry{
+
+	uint32_t label;
+	uint32_t path;
+	uint32_t dir;
+};
+
+struct pl_layer{
+
+	void *map;
+	size_t size;
+
+	const char *root;
+	uint32_t count;
+	const struct pl_entry *entries;
+	const char *strings;
+};
+
+
+// nearest ancestor of cwd holding a .je, NULL if none. Found roots
+// are cached in cache_dir, force_walk skips that cache
+char *PL_find_root(const char *cache_dir, int force_walk); // caller must free
+
+// compiles root/.je into cache_dir if the blob is missing or stale
+int PL_open(const char *root, const char *cache_dir, struct pl_layer *out_layer); // use PL_close()
+
+void PL_close(struct pl_layer *layer);
+
+// binary search, pointers stay valid until PL_close
+int PL_find(struct pl_layer *layer, const char *label, const char **out_path, const char **out_dir);
+
+// first entry whose label is not less than label
+size_t PL_lower_bound(struct pl_layer *layer, const char *label);
+
+// entries in label order for listing
+void PL_get(struct pl_layer *layer, size_t element,
+		const char **out_label, const char **out_path, const char **out_dir);
+
+size_t PL_len(struct pl_layer *layer);
+
+#endif
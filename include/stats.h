@@ -0,0 +1,68 @@
+#ifndef STATS_H
+#define STATS_H
+#include <stdio.h>  // FILE
+#include <stdlib.h> // size_t
+#include <stdint.h>
+
+#define ST_MAX_CMDS 16
+#define ST_BUCKETS 32 // bucket i holds latencies in [2^(i-1), 2^i) microseconds
+
+typedef enum {
+	ST_PHASE_LOCK,    // gdbm_open including waiting on the writer lock
+	ST_PHASE_COMMAND, // everything the sub command does
+	ST_PHASE_TOTAL,   // process start to exit
+	ST_N_PHASES,
+}St_phase;
+
+struct st_histogram{
+
+	uint64_t count;
+	uint64_t sum_us;
+	uint64_t max_us;
+	uint64_t bucket[ST_BUCKETS];
+};
+
+// layout of the mmap'd stats file, every field is updated atomically
+struct st_file{
+
+	char magic[4];
+	uint32_t version;
+
+	uint64_t cmd_count[ST_MAX_CMDS];
+	uint64_t cmd_failed[ST_MAX_CMDS]; // the part of cmd_count that exited with an error
+	struct st_histogram phase[ST_N_PHASES];
+};
+
+struct st_stats{
+
+	struct st_file *file; // NULL if the stats file could not be mapped
+};
+
+// filled in by the caller since the stats file knows nothing about gdbm
+struct st_store{
+
+	uint64_t file_size;
+	uint64_t live_bytes;
+	uint64_t records;
+	uint64_t labels;
+	uint64_t buckets; // 0 if gdbm can't tell
+};
+
+
+int ST_open(const char *path, struct st_stats *out_stats); // use ST_close()
+
+void ST_close(struct st_stats *stats);
+
+uint64_t ST_now_us(void);
+
+void ST_count_cmd(struct st_stats *stats, size_t cmd, int failed);
+
+void ST_record(struct st_stats *stats, St_phase phase, uint64_t elapsed_us);
+
+// latency below which percent of the samples fall, rounded up to the bucket
+uint64_t ST_percentile(struct st_histogram *histogram, double percent);
+
+void ST_print(FILE *stream, struct st_stats *stats, const char **cmd_names, size_t n_cmds,
+		struct st_store *store, int json);
+
+#endif
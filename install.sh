@@ -14,6 +14,11 @@ je() {
 		$1 == list ||
 		$1 == rm ||
 		$1 == default-editor ||
+		$1 == case-insensitive ||
+		$1 == label-editor ||
+		$1 == ext-editor ||
+		$1 == workspace ||
+		$1 == stats ||
 		$1 == --help ||
 		$1 == -h
 		]]; 
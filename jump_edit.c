@@ -11,14 +11,44 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <regex.h>
 #include <gdbm.h>
 #include <unistd.h> 
+#include <ctype.h>
+#include <locale.h>
+#include <wchar.h>
+#include <wctype.h>
 #include "include/arg_parser.h"
+#include "include/project_layer.h"
+#include "include/label_index.h"
+#include "include/stats.h"
+#include "include/prefetch.h"
 
 #define BUF_SIZE 1024
+#define LOCK_WAIT_MS 2000
 #define SEE_HELP "See 'je -h' or 'je --help' for more information\n"
 
+/*
+ * reserved keys carry a '\0' so they can never collide
+ * with a label typed on the command line
+ */
+#define META_KEY "meta\0"
+#define META_KEY_LEN 5
+#define FOLD_PREFIX "fold\0"
+#define FOLD_PREFIX_LEN 5
+
+// settings older versions of je kept as their own keys
+#define LEGACY_EDITOR_KEY "default-editor\0"
+#define LEGACY_EDITOR_KEY_LEN 15
+#define INSENSITIVE_KEY "case-insensitive\0"
+#define INSENSITIVE_KEY_LEN 17
+
+#define MAX_META 64
+#define MAX_GROUP_DEPTH 8
+#define RECORD_VERSION "1"
+#define GROUP_TAG "g"
+
 #if defined(__linux__)
 	#define APP_DATA_DIR "/.local/share/je"
 #elif defined(__APPLE__)
@@ -31,9 +61,29 @@ typedef enum {
 	CMD_ADD, 
 	CMD_REMOVE, 
 	CMD_EDITOR,
+	CMD_INSENSITIVE,
+	CMD_LABEL_EDITOR,
+	CMD_EXT_EDITOR,
+	CMD_WORKSPACE,
+	CMD_STATS,
 	CMD_HELP,
 }Cmd;
 
+// how each command shows up in 'je stats'
+const char *cmd_names[] = {
+	[CMD_OTHER] = "jump",
+	[CMD_LIST] = "list",
+	[CMD_ADD] = "add",
+	[CMD_REMOVE] = "rm",
+	[CMD_EDITOR] = "default-editor",
+	[CMD_INSENSITIVE] = "case-insensitive",
+	[CMD_LABEL_EDITOR] = "label-editor",
+	[CMD_EXT_EDITOR] = "ext-editor",
+	[CMD_WORKSPACE] = "workspace",
+	[CMD_STATS] = "stats",
+	[CMD_HELP] = "help",
+};
+
 Cmd parse_cmd(const char *buf) {
 	// strcmp returns 0 if strings are equal
 	// returns int of the difference between the first 
@@ -42,6 +92,11 @@ Cmd parse_cmd(const char *buf) {
 	if(!strcmp(buf, "add")) return CMD_ADD;
 	if(!strcmp(buf, "rm"))  return CMD_REMOVE; 
 	if(!strcmp(buf, "default-editor"))  return CMD_EDITOR; 
+	if(!strcmp(buf, "case-insensitive"))  return CMD_INSENSITIVE; 
+	if(!strcmp(buf, "label-editor"))  return CMD_LABEL_EDITOR; 
+	if(!strcmp(buf, "ext-editor"))  return CMD_EXT_EDITOR; 
+	if(!strcmp(buf, "workspace"))  return CMD_WORKSPACE; 
+	if(!strcmp(buf, "stats"))  return CMD_STATS; 
 	if(!strcmp(buf, "super-duper-help-page-yah")) return CMD_HELP;
 	return CMD_OTHER;
 }
@@ -120,11 +175,985 @@ int is_file(char *path) {
 	}
 }
 
+/*
+ * set in main when one of the fixed UTF-8 locales loads. Without
+ * one towlower can not be trusted past ascii, so only ascii folds
+ */
+static int fold_unicode = 0;
+
+/*
+ * decodes one UTF-8 sequence at s into out_cp, returns its length
+ * or 0 if it is not valid (overlong, surrogate, past U+10FFFF)
+ */
+static size_t utf8_decode(const unsigned char *s, uint32_t *out_cp) {
+
+	size_t len;
+	uint32_t cp, min;
+	if (s[0] < 0x80) { *out_cp = s[0]; return 1; }
+	else if ((s[0] & 0xe0) == 0xc0) { len = 2; cp = s[0] & 0x1f; min = 0x80; }
+	else if ((s[0] & 0xf0) == 0xe0) { len = 3; cp = s[0] & 0x0f; min = 0x800; }
+	else if ((s[0] & 0xf8) == 0xf0) { len = 4; cp = s[0] & 0x07; min = 0x10000; }
+	else return 0;
+
+	for (size_t i = 1; i < len; i++) {
+		if ((s[i] & 0xc0) != 0x80) return 0;
+		cp = (cp << 6) | (s[i] & 0x3f);
+	}
+	if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) return 0;
+
+	*out_cp = cp;
+	return len;
+}
+
+static size_t utf8_encode(uint32_t cp, char *out) {
+	if (cp < 0x80) {
+		out[0] = cp;
+		return 1;
+	} else if (cp < 0x800) {
+		out[0] = 0xc0 | (cp >> 6);
+		out[1] = 0x80 | (cp & 0x3f);
+		return 2;
+	} else if (cp < 0x10000) {
+		out[0] = 0xe0 | (cp >> 12);
+		out[1] = 0x80 | ((cp >> 6) & 0x3f);
+		out[2] = 0x80 | (cp & 0x3f);
+		return 3;
+	}
+	out[0] = 0xf0 | (cp >> 18);
+	out[1] = 0x80 | ((cp >> 12) & 0x3f);
+	out[2] = 0x80 | ((cp >> 6) & 0x3f);
+	out[3] = 0x80 | (cp & 0x3f);
+	return 4;
+}
+
+/*
+ * folds a label so 'MyProj' and 'myproj' land on the same key.
+ * The UTF-8 is decoded here rather than through mbstowcs so the
+ * result does not depend on the shell's locale. Non ascii code
+ * points are lowered only when fold_unicode is set, a label that
+ * is not valid UTF-8 folds its ascii bytes and keeps the rest
+ */
+char *fold_label(const char *label) {
+
+	size_t len = strlen(label);
+	char *folded = malloc(len * 4 + 1); // a lowered code point may grow
+	if (!folded) { perror("malloc"); exit(1); }
+
+	const unsigned char *s = (const unsigned char*)label;
+	char *out = folded;
+	while (*s) {
+		uint32_t cp;
+		size_t n = utf8_decode(s, &cp);
+		if (n == 0) break; // invalid, redo it ascii only below
+		if (cp < 0x80) cp = tolower(cp);
+		else if (fold_unicode) {
+			wint_t lower = towlower((wint_t)cp);
+			if (lower > 0 && lower <= 0x10ffff && !(lower >= 0xd800 && lower <= 0xdfff)) cp = lower;
+		}
+		out += utf8_encode(cp, out);
+		s += n;
+	}
+
+	if (*s) {
+		out = folded;
+		for (s = (const unsigned char*)label; *s; s++) {
+			*out++ = *s < 0x80 ? tolower(*s) : *s;
+		}
+	}
+	*out = '\0';
+	return folded; // caller must free
+}
+
+/*
+ * the fold index maps "fold\0<folded label>" to every canonical
+ * label that folds to it, each stored with its '\0' i.e.
+ * "MyProj\0myproj\0". More than one entry means a collision
+ */
+datum fold_index_key(const char *label) {
+
+	char *folded = fold_label(label);
+	size_t len = strlen(folded);
+
+	char *buf = malloc(FOLD_PREFIX_LEN + len);
+	if (!buf) { perror("malloc"); exit(1); }
+	memcpy(buf, FOLD_PREFIX, FOLD_PREFIX_LEN);
+	memcpy(buf + FOLD_PREFIX_LEN, folded, len);
+	free(folded);
+
+	datum key = { .dptr = buf, .dsize = FOLD_PREFIX_LEN + len };
+	return key; // caller must free key.dptr
+}
+
+size_t fold_entry_count(datum entry) {
+	size_t count = 0;
+	for (int i = 0; i < entry.dsize; i++) {
+		if (entry.dptr[i] == '\0') count++;
+	}
+	return count;
+}
+
+// prints "'a', 'b'" for every label in a fold index entry
+void fold_entry_print(FILE *stream, datum entry) {
+	for (char *p = entry.dptr; p < entry.dptr + entry.dsize; p += strlen(p) + 1) {
+		fprintf(stream, "%s'%s'", p == entry.dptr ? "" : ", ", p);
+	}
+}
+
+// returns how many labels already folded to the same key, or -1
+int fold_index_add(GDBM_FILE db, const char *label) {
+
+	datum key = fold_index_key(label);
+	datum entry = gdbm_fetch(db, key);
+
+	size_t label_len = strlen(label) + 1; // keep the '\0'
+	size_t old_len = entry.dptr ? entry.dsize : 0;
+
+	char *buf = malloc(old_len + label_len);
+	if (!buf) { perror("malloc"); exit(1); }
+	if (entry.dptr) memcpy(buf, entry.dptr, old_len);
+	memcpy(buf + old_len, label, label_len);
+
+	datum val = { .dptr = buf, .dsize = old_len + label_len };
+	int store_return = gdbm_store(db, key, val, GDBM_REPLACE);
+	int collisions = entry.dptr ? (int)fold_entry_count(entry) : 0;
+
+	free(buf);
+	free(entry.dptr);
+	free(key.dptr);
+	return store_return == -1 ? -1 : collisions;
+}
+
+int fold_index_remove(GDBM_FILE db, const char *label) {
+
+	datum key = fold_index_key(label);
+	datum entry = gdbm_fetch(db, key);
+	if (entry.dptr == NULL) {
+		free(key.dptr);
+		return 0; // label was added before the index existed
+	}
+
+	// copy every label except the removed one
+	char *buf = malloc(entry.dsize);
+	if (!buf) { perror("malloc"); exit(1); }
+	size_t len = 0;
+	for (char *p = entry.dptr; p < entry.dptr + entry.dsize; p += strlen(p) + 1) {
+		if (strcmp(p, label)) {
+			memcpy(buf + len, p, strlen(p) + 1);
+			len += strlen(p) + 1;
+		}
+	}
+
+	int rc;
+	if (len == 0) {
+		rc = gdbm_delete(db, key);
+	} else {
+		datum val = { .dptr = buf, .dsize = len };
+		rc = gdbm_store(db, key, val, GDBM_REPLACE);
+	}
+
+	free(buf);
+	free(entry.dptr);
+	free(key.dptr);
+	return rc;
+}
+
+/*
+ * one probe into the fold index. Returns the canonical label
+ * or NULL if nothing folds to label. Exits if the label is
+ * ambiguous because the user has to pick one
+ */
+char *fold_index_resolve(GDBM_FILE db, const char *label) {
+
+	datum key = fold_index_key(label);
+	datum entry = gdbm_fetch(db, key);
+	free(key.dptr);
+
+	if (entry.dptr == NULL) {
+		if (gdbm_errno != GDBM_ITEM_NOT_FOUND) {
+			fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
+			exit(EXIT_FAILURE);
+		}
+		return NULL;
+	}
+
+	if (fold_entry_count(entry) > 1) {
+		fprintf(stderr, "Error: '%s' is ambiguous, it matches ", label);
+		fold_entry_print(stderr, entry);
+		fprintf(stderr, "\n");
+		exit(EXIT_FAILURE);
+	}
+
+	char *canonical = strdup(entry.dptr);
+	if (!canonical) { perror("malloc"); exit(1); }
+	free(entry.dptr);
+	return canonical; // caller must free
+}
+
+/*
+ * can't delete or store while walking gdbm keys so
+ * commands that rewrite records collect every key first
+ */
+datum *collect_keys(GDBM_FILE db, size_t *out_n) {
+
+	size_t n_keys = 0, cap = 16;
+	datum *keys = malloc(cap * sizeof(datum));
+	if (!keys) { perror("malloc"); exit(1); }
+
+	datum key = gdbm_firstkey(db);
+	while (key.dptr != NULL) {
+		if (n_keys == cap) {
+			cap *= 2;
+			keys = realloc(keys, cap * sizeof(datum));
+			if (!keys) { perror("realloc"); exit(1); }
+		}
+		keys[n_keys++] = key;
+		key = gdbm_nextkey(db, key);
+	}
+
+	*out_n = n_keys;
+	return keys; // caller must free each dptr and keys
+}
+
+// anything without a '\0' in its key is a user label
+int is_label_key(datum key) {
+	return memchr(key.dptr, '\0', key.dsize) == NULL;
+}
+
+/*
+ * drops and recreates every fold index entry from the labels
+ * in the database. Only runs when insensitive mode is turned on
+ * so labels added by older versions of je get indexed too
+ */
+void fold_index_rebuild(GDBM_FILE db) {
+
+	size_t n_keys;
+	datum *keys = collect_keys(db, &n_keys);
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (keys[i].dsize > FOLD_PREFIX_LEN &&
+				!memcmp(keys[i].dptr, FOLD_PREFIX, FOLD_PREFIX_LEN)) {
+			gdbm_delete(db, keys[i]);
+		}
+	}
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (is_label_key(keys[i])) {
+			char *labelstr = malloc(keys[i].dsize + 1);
+			if (!labelstr) { perror("malloc"); exit(1); }
+			memcpy(labelstr, keys[i].dptr, keys[i].dsize);
+			labelstr[keys[i].dsize] = '\0';
+			if (fold_index_add(db, labelstr) > 0) {
+				fprintf(stderr, "Warning: label '%s' only differs in case from another label, "
+						"insensitive lookups of it will be ambiguous\n", labelstr);
+			}
+			free(labelstr);
+		}
+		free(keys[i].dptr);
+	}
+	free(keys);
+}
+
+/*
+ * every global setting lives in one metadata record stored as
+ * "name\0value\0name\0value\0". Extension editors are named
+ * "ext:.md" and so on
+ */
+struct je_meta {
+	int n;
+	char *name[MAX_META];
+	char *val[MAX_META];
+};
+
+const char *meta_get(struct je_meta *meta, const char *name) {
+	for (int i = 0; i < meta->n; i++) {
+		if (!strcmp(meta->name[i], name)) return meta->val[i];
+	}
+	return NULL;
+}
+
+// val of NULL removes the setting
+void meta_set(struct je_meta *meta, const char *name, const char *val) {
+
+	for (int i = 0; i < meta->n; i++) {
+		if (!strcmp(meta->name[i], name)) {
+			free(meta->val[i]);
+			if (val != NULL) {
+				meta->val[i] = strdup(val);
+				if (!meta->val[i]) { perror("malloc"); exit(1); }
+			} else {
+				free(meta->name[i]);
+				meta->n--;
+				meta->name[i] = meta->name[meta->n];
+				meta->val[i] = meta->val[meta->n];
+			}
+			return;
+		}
+	}
+
+	if (val == NULL) return;
+
+	if (meta->n == MAX_META) {
+		fprintf(stderr, "Error: can not store more than %d settings\n", MAX_META);
+		exit(EXIT_FAILURE);
+	}
+
+	meta->name[meta->n] = strdup(name);
+	meta->val[meta->n] = strdup(val);
+	if (!meta->name[meta->n] || !meta->val[meta->n]) { perror("malloc"); exit(1); }
+	meta->n++;
+}
+
+void meta_free(struct je_meta *meta) {
+	for (int i = 0; i < meta->n; i++) {
+		free(meta->name[i]);
+		free(meta->val[i]);
+	}
+	meta->n = 0;
+}
+
+// copies a datum that was stored without a '\0' into a string
+char *datum_to_str(datum d) {
+	char *str = malloc(d.dsize + 1);
+	if (!str) { perror("malloc"); exit(1); }
+	memcpy(str, d.dptr, d.dsize);
+	str[d.dsize] = '\0';
+	return str; // caller must free
+}
+
+void meta_load(GDBM_FILE db, struct je_meta *meta) {
+
+	meta->n = 0;
+
+	datum key = { (void*)META_KEY, META_KEY_LEN };
+	datum fetched = gdbm_fetch(db, key);
+
+	if (fetched.dptr != NULL) {
+		char *end = fetched.dptr + fetched.dsize;
+		char *p = fetched.dptr;
+		while (p < end) {
+			char *name = p;
+			p += strlen(p) + 1;
+			if (p >= end) break;
+			char *val = p;
+			p += strlen(p) + 1;
+			meta_set(meta, name, val);
+		}
+		free(fetched.dptr);
+		return;
+	}
+
+	// settings written by older versions of je as their own
+	// keys, moved into the metadata record on the next store
+	datum editor_key = { (void*)LEGACY_EDITOR_KEY, LEGACY_EDITOR_KEY_LEN };
+	datum editor = gdbm_fetch(db, editor_key);
+	if (editor.dptr != NULL) {
+		char *editorstr = datum_to_str(editor);
+		meta_set(meta, "default-editor", editorstr);
+		free(editorstr);
+		free(editor.dptr);
+	}
+
+	datum insensitive_key = { (void*)INSENSITIVE_KEY, INSENSITIVE_KEY_LEN };
+	datum insensitive = gdbm_fetch(db, insensitive_key);
+	if (insensitive.dptr != NULL) {
+		if (insensitive.dsize > 0 && insensitive.dptr[0] == '1') {
+			meta_set(meta, "case-insensitive", "1");
+		}
+		free(insensitive.dptr);
+	}
+}
+
+int meta_store(GDBM_FILE db, struct je_meta *meta) {
+
+	size_t len = 0;
+	for (int i = 0; i < meta->n; i++) {
+		len += strlen(meta->name[i]) + 1 + strlen(meta->val[i]) + 1;
+	}
+
+	char *buf = malloc(len + 1);
+	if (!buf) { perror("malloc"); exit(1); }
+	char *p = buf;
+	for (int i = 0; i < meta->n; i++) {
+		p = stpcpy(p, meta->name[i]) + 1;
+		p = stpcpy(p, meta->val[i]) + 1;
+	}
+
+	datum key = { (void*)META_KEY, META_KEY_LEN };
+	datum val = { .dptr = buf, .dsize = len };
+	int store_return = gdbm_store(db, key, val, GDBM_REPLACE);
+	free(buf);
+
+	if (store_return == 0) {
+		datum editor_key = { (void*)LEGACY_EDITOR_KEY, LEGACY_EDITOR_KEY_LEN };
+		datum insensitive_key = { (void*)INSENSITIVE_KEY, INSENSITIVE_KEY_LEN };
+		gdbm_delete(db, editor_key);
+		gdbm_delete(db, insensitive_key);
+	}
+
+	return store_return;
+}
+
+int insensitive_enabled(struct je_meta *meta) {
+	const char *val = meta_get(meta, "case-insensitive");
+	return val != NULL && val[0] == '1';
+}
+
+/*
+ * a label record is "1\0path\0dir\0editor\0resolved\0" where
+ * editor is the per label override (may be empty) and resolved
+ * is the editor a jump will run, cached so a jump only needs
+ * to fetch the label. Older versions of je stored "path:::dir"
+ */
+struct je_label {
+	char *path;
+	char *dir;
+	char *editor;
+	char *resolved; // NULL if the record predates the cache
+};
+
+int label_decode(datum fetched, struct je_label *lab) {
+
+	memset(lab, 0, sizeof(*lab));
+
+	if (memchr(fetched.dptr, '\0', fetched.dsize) == NULL) {
+		char *valstr = datum_to_str(fetched);
+		char *pattern = "^(.+):::(.+)$";
+		lab->path = get_matches(pattern, valstr, 1, 2);
+		lab->dir = get_matches(pattern, valstr, 2, 2);
+		lab->editor = strdup("");
+		free(valstr);
+		return (lab->path && lab->dir && lab->editor) ? 0 : -1;
+	}
+
+	char *fields[5];
+	int n_fields = 0;
+	char *end = fetched.dptr + fetched.dsize;
+	for (char *p = fetched.dptr; p < end && n_fields < 5; p += strlen(p) + 1) {
+		fields[n_fields++] = p;
+	}
+
+	if (n_fields != 5 || strcmp(fields[0], RECORD_VERSION)) {
+		return -1;
+	}
+
+	lab->path = strdup(fields[1]);
+	lab->dir = strdup(fields[2]);
+	lab->editor = strdup(fields[3]);
+	lab->resolved = strdup(fields[4]);
+	if (!lab->path || !lab->dir || !lab->editor || !lab->resolved) { perror("malloc"); exit(1); }
+
+	return 0;
+}
+
+datum label_encode(struct je_label *lab) {
+
+	const char *fields[5] = {
+		RECORD_VERSION, lab->path, lab->dir, lab->editor,
+		lab->resolved ? lab->resolved : "",
+	};
+
+	size_t len = 0;
+	for (int i = 0; i < 5; i++) len += strlen(fields[i]) + 1;
+
+	char *buf = malloc(len);
+	if (!buf) { perror("malloc"); exit(1); }
+	char *p = buf;
+	for (int i = 0; i < 5; i++) p = stpcpy(p, fields[i]) + 1;
+
+	datum val = { .dptr = buf, .dsize = len };
+	return val; // caller must free val.dptr
+}
+
+void label_free(struct je_label *lab) {
+	free(lab->path);
+	free(lab->dir);
+	free(lab->editor);
+	free(lab->resolved);
+}
+
+// ".md" for "notes/todo.md", NULL for "~/.bashrc" or "~/.config"
+const char *path_extension(const char *path) {
+	const char *base = strrchr(path, '/');
+	base = base ? base + 1 : path;
+	const char *dot = strrchr(base, '.');
+	return (dot != NULL && dot != base) ? dot : NULL;
+}
+
+// label override, then extension editor, then default editor
+const char *resolve_editor(struct je_meta *meta, struct je_label *lab) {
+
+	if (lab->editor != NULL && lab->editor[0] != '\0') return lab->editor;
+
+	const char *ext = path_extension(lab->path);
+	if (ext != NULL) {
+		char name[BUF_SIZE];
+		int char_written = snprintf(name, BUF_SIZE, "ext:%s", ext);
+		assert(char_written < BUF_SIZE);
+		const char *editor = meta_get(meta, name);
+		if (editor != NULL) return editor;
+	}
+
+	const char *editor = meta_get(meta, "default-editor");
+	return editor ? editor : "";
+}
+
+/*
+ * refreshes the cached editor of every label. Runs whenever
+ * the metadata record changes, which is rare next to jumps
+ */
+void relabel_all(GDBM_FILE db, struct je_meta *meta) {
+
+	size_t n_keys;
+	datum *keys = collect_keys(db, &n_keys);
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (is_label_key(keys[i])) {
+			datum fetched = gdbm_fetch(db, keys[i]);
+			struct je_label lab;
+			if (fetched.dptr != NULL && label_decode(fetched, &lab) == 0) {
+				free(lab.resolved);
+				lab.resolved = strdup(resolve_editor(meta, &lab));
+				if (!lab.resolved) { perror("malloc"); exit(1); }
+				datum val = label_encode(&lab);
+				gdbm_store(db, keys[i], val, GDBM_REPLACE);
+				free(val.dptr);
+				label_free(&lab);
+			}
+			free(fetched.dptr);
+		}
+		free(keys[i].dptr);
+	}
+	free(keys);
+}
+
+/*
+ * a workspace record is "g\0" followed by its members in order,
+ * "l\0label\0" for a label or "p\0path\0dir\0" for a plain path.
+ * Members are tagged when the workspace is added so a jump
+ * never has to guess
+ */
+int is_group_record(datum fetched) {
+	return fetched.dsize >= 2 && fetched.dptr[0] == GROUP_TAG[0] && fetched.dptr[1] == '\0';
+}
+
+// prints "a, b, ~/notes.md" for the members of a workspace
+void group_print(FILE *stream, datum fetched) {
+	char *end = fetched.dptr + fetched.dsize;
+	char *p = fetched.dptr + 2;
+	const char *sep = "";
+	while (p < end) {
+		char *kind = p;
+		p += strlen(p) + 1;
+		if (p >= end) break;
+		fprintf(stream, "%s%s", sep, p);
+		p += strlen(p) + 1;
+		if (kind[0] == 'p') p += strlen(p) + 1; // skip the shell dir
+		sep = ", ";
+	}
+}
+
+// one label in the format picked by the je list options
+void print_label(struct ap_arg *list, const char *label, struct je_label *lab,
+		const char *editor, const char *note) {
+
+	if(AP_has_flag(list, "-l", "--label")) {
+		printf("%s, ", label);
+	} else if (AP_has_flag(list, "-j", "--jump")) {
+		printf("L: %s%s | JP: %s\n", label, note, lab->path);
+	} else if (AP_has_flag(list, "-d", "--directory")) {
+		printf("L: %s%s | SD: %s\n", label, note, lab->dir);
+	} else {
+		printf("L: %s%s \n"
+			   "├JP: %s\n"
+			   "├SD: %s\n"
+			   "└ED: %s%s\n\n"
+				, label, note, lab->path, lab->dir, editor,
+				lab->editor[0] != '\0' ? " (label editor)" : "");
+	}
+}
+
+void print_group(struct ap_arg *list, const char *label, datum fetched, const char *note) {
+
+	if(AP_has_flag(list, "-l", "--label")) {
+		printf("%s, ", label);
+	} else if (AP_has_flag(list, "-j", "--jump") || AP_has_flag(list, "-d", "--directory")) {
+		printf("L: %s%s | WS: ", label, note);
+		group_print(stdout, fetched);
+		printf("\n");
+	} else {
+		printf("L: %s%s \n└WS: ", label, note);
+		group_print(stdout, fetched);
+		printf("\n\n");
+	}
+}
+
+// str as one shell word, '...' with each ' written as '\''
+char *shell_quote(const char *str) {
+
+	size_t len = 2;
+	for (const char *c = str; *c; c++) len += *c == '\'' ? 4 : 1;
+
+	char *quoted = malloc(len + 1);
+	if (!quoted) { perror("malloc"); exit(1); }
+
+	char *p = quoted;
+	*p++ = '\'';
+	for (const char *c = str; *c; c++) {
+		if (*c == '\'') p = stpcpy(p, "'\\''");
+		else *p++ = *c;
+	}
+	*p++ = '\'';
+	*p = '\0';
+	return quoted; // caller must free
+}
+
+// metadata is only fetched once and only if a jump needs it
+struct je_meta *meta_need(GDBM_FILE db, struct je_meta *meta) {
+	if (meta->n < 0) meta_load(db, meta);
+	return meta;
+}
+
+// exact label first, then one probe into the fold index
+datum fetch_label(GDBM_FILE db, const char *label, struct je_meta *meta) {
+
+	datum label_key = { (void*)label, strlen(label) };
+	datum fetched = gdbm_fetch(db, label_key);
+
+	// loading the metadata fetches too and resets gdbm_errno
+	int missing = fetched.dptr == NULL && gdbm_errno == GDBM_ITEM_NOT_FOUND;
+
+	if (missing && insensitive_enabled(meta_need(db, meta))) {
+		char *canonical = fold_index_resolve(db, label);
+		if (canonical != NULL) {
+			datum canonical_key = { (void*)canonical, strlen(canonical) };
+			fetched = gdbm_fetch(db, canonical_key);
+			missing = fetched.dptr == NULL && gdbm_errno == GDBM_ITEM_NOT_FOUND;
+			free(canonical);
+		}
+	}
+
+	if (fetched.dptr == NULL) {
+		if (missing) {
+			fprintf(stderr, "Error: \'%s\' is not a je label.\n", label);
+			fprintf(stderr, "See 'je list' for a list of user jumps\n" SEE_HELP);
+			exit(EXIT_FAILURE);
+		} else {
+			fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	return fetched; // caller must free fetched.dptr
+}
+
+struct je_targets {
+	size_t n;
+	size_t cap;
+	struct je_label *lab;
+};
+
+void targets_push(struct je_targets *targets, struct je_label *lab) {
+	if (targets->n == targets->cap) {
+		targets->cap = targets->cap ? targets->cap * 2 : 8;
+		targets->lab = realloc(targets->lab, targets->cap * sizeof(struct je_label));
+		if (!targets->lab) { perror("realloc"); exit(1); }
+	}
+	targets->lab[targets->n++] = *lab;
+}
+
+// an earlier target in [from, i) opens the same path with the same editor
+int target_repeats(struct je_targets *targets, size_t from, size_t i) {
+	for (size_t j = from; j < i; j++) {
+		if (!strcmp(targets->lab[j].resolved, targets->lab[i].resolved)
+				&& !strcmp(targets->lab[j].path, targets->lab[i].path)) return 1;
+	}
+	return 0;
+}
+
+/*
+ * turns one label or workspace into jump targets, workspaces
+ * expand to their members in order. depth stops workspaces
+ * that end up containing themselves
+ */
+void resolve_targets(GDBM_FILE db, struct pl_layer *layer, const char *label,
+		struct je_meta *meta, struct je_targets *targets, int depth) {
+
+	if (depth > MAX_GROUP_DEPTH) {
+		fprintf(stderr, "Error: workspace '%s' nests deeper than %d workspaces\n",
+				label, MAX_GROUP_DEPTH);
+		exit(EXIT_FAILURE);
+	}
+
+	// project labels sit on top of the personal database
+	const char *project_path, *project_dir;
+	if (PL_find(layer, label, &project_path, &project_dir)) {
+		struct je_label lab = {
+			.path = strdup(project_path),
+			.dir = strdup(project_dir),
+			.editor = strdup(""),
+		};
+		if (!lab.path || !lab.dir || !lab.editor) { perror("malloc"); exit(1); }
+		lab.resolved = strdup(resolve_editor(meta_need(db, meta), &lab));
+		if (!lab.resolved) { perror("malloc"); exit(1); }
+		targets_push(targets, &lab);
+		return;
+	}
+
+	datum fetched = fetch_label(db, label, meta);
+
+	if (is_group_record(fetched)) {
+
+		char *end = fetched.dptr + fetched.dsize;
+		char *p = fetched.dptr + 2;
+		while (p < end) {
+			char *kind = p;
+			p += strlen(p) + 1;
+			if (p >= end) break;
+
+			if (kind[0] == 'l') {
+				resolve_targets(db, layer, p, meta, targets, depth + 1);
+				p += strlen(p) + 1;
+			} else {
+				struct je_label lab = { .editor = strdup("") };
+				lab.path = strdup(p);
+				p += strlen(p) + 1;
+				lab.dir = strdup(p < end ? p : lab.path);
+				p += strlen(p) + 1;
+				if (!lab.path || !lab.dir || !lab.editor) { perror("malloc"); exit(1); }
+				lab.resolved = strdup(resolve_editor(meta_need(db, meta), &lab));
+				if (!lab.resolved) { perror("malloc"); exit(1); }
+				targets_push(targets, &lab);
+			}
+		}
+
+	} else {
+
+		struct je_label lab;
+		if (label_decode(fetched, &lab) != 0) {
+			fprintf(stderr, "Error: label '%s' has a corrupt record, "
+					"use 'je rm %s' and add it again\n", label, label);
+			exit(EXIT_FAILURE);
+		}
+
+		// records written by older versions of je have no
+		// cached editor and still need the metadata
+		if (lab.resolved == NULL) {
+			lab.resolved = strdup(resolve_editor(meta_need(db, meta), &lab));
+			if (!lab.resolved) { perror("malloc"); exit(1); }
+		}
+
+		targets_push(targets, &lab);
+	}
+
+	free(fetched.dptr);
+}
+
+// layer is left empty if cwd is not inside a project
+void open_project_layer(const char *cache_dir, struct pl_layer *layer) {
+
+	char *root = PL_find_root(cache_dir, 0);
+	if (root != NULL && PL_open(root, cache_dir, layer) < 0) {
+		// the cached project went away, look again
+		free(root);
+		root = PL_find_root(cache_dir, 1);
+		if (root != NULL && PL_open(root, cache_dir, layer) < 0) {
+			fprintf(stderr, "Warning: could not read %s/%s, project labels skipped\n",
+					root, PL_FILE_NAME);
+		}
+	}
+	if (root == NULL) memset(layer, 0, sizeof(*layer));
+	free(root);
+}
+
+int label_cmp(const void *a, const void *b) {
+	return strcmp(*(const char**)a, *(const char**)b);
+}
+
+/*
+ * the database file as it is right now. Writers flush first so gdbm
+ * writing out its buffers later can't change the file after the
+ * label index recorded it, readers only need the fstat
+ */
+void db_source(GDBM_FILE db, int flush, struct li_source *out_source) {
+	struct stat st;
+	if ((flush && gdbm_sync(db) < 0) || fstat(gdbm_fdesc(db), &st) < 0) {
+		fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
+		exit(EXIT_FAILURE);
+	}
+	out_source->mtime_sec = PL_MTIME(&st).tv_sec;
+	out_source->mtime_nsec = PL_MTIME(&st).tv_nsec;
+	out_source->size = st.st_size;
+}
+
+// the database is already written, only the index is behind
+void label_index_failed(void) {
+	fprintf(stderr, "Error: labels are saved but the label index could not be updated: %s\n"
+			"It is rebuilt the next time je reads it\n", strerror(errno));
+	exit(EXIT_FAILURE);
+}
+
+int label_index_build(GDBM_FILE db, const char *index_path) {
+
+	size_t n_keys, n_labels = 0;
+	datum *keys = collect_keys(db, &n_keys);
+	char **labels = malloc((n_keys + 1) * sizeof(char*));
+	if (!labels) { perror("malloc"); exit(1); }
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (is_label_key(keys[i])) labels[n_labels++] = datum_to_str(keys[i]);
+		free(keys[i].dptr);
+	}
+	free(keys);
+
+	qsort(labels, n_labels, sizeof(char*), label_cmp);
+
+	struct li_source source;
+	db_source(db, 1, &source);
+	int rc = LI_write(index_path, (const char**)labels, n_labels, &source);
+
+	for (size_t i = 0; i < n_labels; i++) free(labels[i]);
+	free(labels);
+	return rc;
+}
+
+/*
+ * opens the sorted label index. It is rebuilt from a scan of the
+ * database when it is missing or the database file changed since
+ * it was written, which is what any writer that skipped it (an
+ * older je, a failed update) leaves behind
+ */
+void label_index_open(GDBM_FILE db, const char *index_path, struct li_index *index) {
+
+	if (LI_open(index_path, index) == 0) {
+		struct li_source now;
+		db_source(db, 0, &now);
+		if (LI_same_source(&index->source, &now)) return;
+		LI_close(index);
+	}
+
+	if (label_index_build(db, index_path) < 0 || LI_open(index_path, index) < 0) {
+		perror("label index");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * writers take the database source before they change anything,
+ * the index is only patched if it was in step with that source and
+ * rebuilt otherwise. Call after every other record of the write is
+ * stored
+ */
+void label_index_insert(GDBM_FILE db, const char *index_path, const char *label,
+		struct li_source *before) {
+	struct li_index index;
+	int in_step = LI_open(index_path, &index) == 0 && LI_same_source(&index.source, before);
+	LI_close(&index);
+
+	struct li_source after;
+	db_source(db, 1, &after);
+
+	int rc = in_step
+		? LI_insert(index_path, label, &after)
+		: label_index_build(db, index_path);
+	if (rc < 0) label_index_failed();
+}
+
+void label_index_remove(GDBM_FILE db, const char *index_path, const char *label,
+		struct li_source *before) {
+	struct li_index index;
+	int in_step = LI_open(index_path, &index) == 0 && LI_same_source(&index.source, before);
+	size_t at = LI_lower_bound(&index, label);
+	int found = at < LI_len(&index) && !strcmp(LI_get(&index, at), label);
+	LI_close(&index);
+
+	struct li_source after;
+	db_source(db, 1, &after);
+
+	int rc = in_step && found
+		? LI_remove_range(index_path, at, at + 1, &after)
+		: label_index_build(db, index_path);
+	if (rc < 0) label_index_failed();
+}
+
+// 'work' and 'work/' both mean every label under "work/"
+char *namespace_prefix(const char *name) {
+	size_t len = strlen(name);
+	char *prefix = malloc(len + 2);
+	if (!prefix) { perror("malloc"); exit(1); }
+	memcpy(prefix, name, len + 1);
+	if (len == 0 || name[len - 1] != '/') strcpy(prefix + len, "/");
+	return prefix; // caller must free
+}
+
+// [from, to) of the labels starting with prefix, O(log n + k)
+void namespace_range(struct li_index *index, const char *prefix, size_t *out_from, size_t *out_to) {
+	size_t len = strlen(prefix);
+	size_t at = LI_lower_bound(index, prefix);
+	*out_from = at;
+	while (at < LI_len(index) && !strncmp(LI_get(index, at), prefix, len)) at++;
+	*out_to = at;
+}
+
+// in insensitive mode a label that only differs in case
+// from another one could never be reached, so refuse it
+void fold_index_check(GDBM_FILE db, datum key, const char *label) {
+
+	datum fold_key = fold_index_key(label);
+	datum fold_entry = gdbm_fetch(db, fold_key);
+	free(fold_key.dptr);
+
+	if (fold_entry.dptr != NULL && !gdbm_exists(db, key)) {
+		fprintf(stderr, "Error: could not add jump label '%s' because it only differs "
+				"in case from ", label);
+		fold_entry_print(stderr, fold_entry);
+		fprintf(stderr, ". Use 'je rm <label>' first or 'je case-insensitive off'\n");
+		exit(EXIT_FAILURE);
+	}
+	free(fold_entry.dptr);
+}
+
+/*
+ * most errors exit() from wherever they happen, so the stats of a
+ * run are recorded by an atexit hook instead of at the end of main
+ */
+struct je_run {
+	struct st_stats stats;
+	Cmd cmd;
+	uint64_t start_us;
+	uint64_t command_start_us; // 0 until the command starts
+	int finished;              // main got to the end
+};
+
+static struct je_run run;
+
+void record_run(void) {
+	if (run.command_start_us) {
+		ST_record(&run.stats, ST_PHASE_COMMAND, ST_now_us() - run.command_start_us);
+	}
+	ST_count_cmd(&run.stats, run.cmd, !run.finished);
+	ST_record(&run.stats, ST_PHASE_TOTAL, ST_now_us() - run.start_us);
+	ST_close(&run.stats);
+}
+
 int main(int argc, char **argv) {
 	
+	run.start_us = ST_now_us();
+
 	// arg1 will be a sub_command or a jump descriptor
 	Cmd cmd;
 
+	// label folding has to give the same answer no matter what
+	// locale the shell is in, otherwise the fold index breaks.
+	// Only fixed UTF-8 locales are tried (never ""), if none loads
+	// non ascii is left as is rather than folded by LANG
+	const char *fold_locales[] = { "C.UTF-8", "en_US.UTF-8", "UTF-8" };
+	for (size_t i = 0; i < sizeof(fold_locales) / sizeof(*fold_locales); i++) {
+		if (setlocale(LC_CTYPE, fold_locales[i]) != NULL) {
+			fold_unicode = 1;
+			break;
+		}
+	}
+
 	// create argument parse tree
 	struct ap_arg *head = NULL;
 	int rc = AP_parse(argc, argv, &head);
@@ -170,6 +1199,16 @@ int main(int argc, char **argv) {
 	int char_written= snprintf(je_dir, BUF_SIZE, "%s%s", xdg_data_home, APP_DATA_DIR);
 	assert(char_written < BUF_SIZE); // if attempted chars does not fit into buffer
 
+	// compiled project .je files live next to the database
+	char je_cache_dir[BUF_SIZE];
+	char_written = snprintf(je_cache_dir, BUF_SIZE, "%s/projects", je_dir);
+	assert(char_written < BUF_SIZE);
+
+	// sorted label index for namespace listing and removal
+	char je_index_path[BUF_SIZE];
+	char_written = snprintf(je_index_path, BUF_SIZE, "%s/labels.idx", je_dir);
+	assert(char_written < BUF_SIZE);
+
 	// concat je directory to je.gdbm database file
 	char je_gdbm_dir[BUF_SIZE];
 	char_written = snprintf(je_gdbm_dir, BUF_SIZE, "%s/je.gdbm", je_dir);
@@ -188,116 +1227,178 @@ int main(int argc, char **argv) {
 	}
 	
 	
+	// stats are best effort, je works the same without them
+	char je_stats_path[BUF_SIZE];
+	char_written = snprintf(je_stats_path, BUF_SIZE, "%s/stats.bin", je_dir);
+	assert(char_written < BUF_SIZE);
+
+	struct st_stats *stats = &run.stats;
+	if (ST_open(je_stats_path, stats) == 0) {
+		run.cmd = cmd;
+		atexit(record_run);
+	}
+	
 	// Set up database
+	// every je opens as the writer, so two je's started at the same
+	// moment (two shells, a script) used to have the second one fail
+	// with "Can't open database". Wait for the lock for a bit instead,
+	// the wait shows up as lock latency in 'je stats'
+	uint64_t lock_start_us = ST_now_us();
 	GDBM_FILE db = gdbm_open(je_gdbm_dir, 0, GDBM_WRCREAT, 0600, NULL);
-	if(db == NULL) fprintf(stderr, "Can't open database: %s\n",
-			gdbm_strerror(gdbm_errno));
-
-	// handle commands
-	switch(cmd) {
-		case CMD_OTHER: { // check db for user commands
-
-			struct ap_arg *label = AP_get(head, 1);
-
-			if (num_args > 2) {
-				fprintf(stderr, "Error: too many arguments\n" SEE_HELP);
-				exit(EXIT_FAILURE);
-			}
-
-			datum label_key;
-				label_key.dptr = (void*)label->str; 
-				label_key.dsize = strlen(label->str);
-
-			datum fetched = gdbm_fetch(db, label_key);
-
-			if (fetched.dptr == NULL) {
-				if (gdbm_errno == GDBM_ITEM_NOT_FOUND) {
-					fprintf(stderr, "Error: \'%s\' is not a je label.\n", label->str);
-					fprintf(stderr, "See 'je list' for a list of user jumps\n" SEE_HELP);
-					exit(EXIT_FAILURE);
-				} else {
-					fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
-					exit(EXIT_FAILURE);
-				}
-			} else {
+	for (int waited_ms = 0; db == NULL && gdbm_errno == GDBM_CANT_BE_WRITER
+			&& waited_ms < LOCK_WAIT_MS; waited_ms += 10) {
+		usleep(10 * 1000);
+		db = gdbm_open(je_gdbm_dir, 0, GDBM_WRCREAT, 0600, NULL);
+	}
+	if(db == NULL) {
+		fprintf(stderr, "Can't open database: %s\n", gdbm_strerror(gdbm_errno));
+		exit(EXIT_FAILURE);
+	}
+	ST_record(stats, ST_PHASE_LOCK, ST_now_us() - lock_start_us);
 
-				// prepare jump path and shell dir for pattern matching
-				char *valstr = malloc(fetched.dsize + 1);
-				memcpy(valstr, fetched.dptr, fetched.dsize);
-				valstr[fetched.dsize] = '\0';
+	run.command_start_us = ST_now_us();
 
-				char *pattern = "^(.+):::(.+)$";
-				char *pathstr = get_matches(pattern, valstr, 1, 2);
-				char *dirstr = get_matches(pattern, valstr, 2, 2);
+	// handle commands
+	switch(cmd) {
+		case CMD_OTHER: { // check db for user commands
 
-				// add quotes around each path as a guard against spacing
-				// in path. Might as well just put quotes around every path
-				// instead of checking if it has spaces for simplicity
-				int needed = snprintf(NULL, 0, "\"%s\"", pathstr);
-				char *quoted_pathstr = malloc(needed + 1);
-				if (!quoted_pathstr) { perror("malloc"); exit(1); }
-				snprintf(quoted_pathstr, needed + 1, "\"%s\"", pathstr);
+			// every argument is a label or workspace and all of
+			// them are resolved against the one open database
+			struct je_meta meta = { .n = -1 }; // loaded on demand
+			struct je_targets targets = { 0 };
 
-				needed = snprintf(NULL, 0, "\"%s\"", dirstr);
-				char *quoted_dirstr = malloc(needed + 1);
-				if (!quoted_dirstr) { perror("malloc"); exit(1); }
-				snprintf(quoted_dirstr, needed + 1, "\"%s\"", dirstr);
+			struct pl_layer layer;
+			open_project_layer(je_cache_dir, &layer);
 
-			
-				// grab default editor from db
-				datum default_editor_key = { (void*)"default-editor\0", 15 };
-				datum fetched_editor = gdbm_fetch(db, default_editor_key);
-				// free(default_editor_key.dptr);
-
-				if (fetched_editor.dptr == NULL) {
-					if (gdbm_errno == GDBM_ITEM_NOT_FOUND) {
-						fprintf(stderr, "Error: Could not run command because a default editor has not been set. ");
-						fprintf(stderr, "use 'je default-editor [editor command]' to set\n");
-						exit(EXIT_FAILURE);
-					} else {
-						fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
-						exit(EXIT_FAILURE);
-					}
-				}
+			AP_FOREACH(label, head->next) {
+				resolve_targets(db, &layer, label->str, &meta, &targets, 0);
+			}
 
+			// stdout will be read by bash script and executed 
+			struct ap_arg *je = AP_get(head, 0);
+			int jump = AP_has_flag(je, "-j", "--jump");
+			int edit = !jump && AP_has_flag(je, "-e", "--edit");
+			int tmux = AP_has_flag(je, "-t", "--tmux");
 
-				size_t ed_len = fetched_editor.dsize;
-				char *default_editor = malloc(ed_len + 1);
-				if(!default_editor) {perror("malloc"); exit(1); }
-				memcpy(default_editor, fetched_editor.dptr, ed_len);
-				default_editor[ed_len] = '\0';
+			for (size_t i = 0; i < targets.n && !jump; i++) {
+				if (targets.lab[i].resolved[0] == '\0') {
+					fprintf(stderr, "Error: Could not run command because a default editor has not been set. ");
+					fprintf(stderr, "use 'je default-editor [editor command]' to set\n");
+					exit(EXIT_FAILURE);
+				}
+			}
 
+			// warm the caches for whatever the editor and the shell
+			// are about to open while the script is being printed
+			if (!AP_has_flag(je, NULL, "--no-prefetch")) {
+				const char **warm = malloc(2 * targets.n * sizeof(char*));
+				if (!warm) { perror("malloc"); exit(1); }
+				size_t n_warm = 0;
+				for (size_t i = 0; i < targets.n; i++) {
+					if (!jump) warm[n_warm++] = targets.lab[i].path;
+					// a directory label's dir is its path, warm it once
+					if (!edit && (jump || strcmp(targets.lab[i].dir, targets.lab[i].path))) {
+						warm[n_warm++] = targets.lab[i].dir;
+					}
+				}
+				PF_spawn(warm, n_warm);
+				free(warm);
+			}
 
-				// stdout will be read by bash script and executed 
-				struct ap_arg *je = AP_get(head, 0);
+			// the shell evals this, and paths can come from a checked
+			// in .je, so every path and dir is single quoted. Inside
+			// '...' the shell expands nothing, a ' is written as '\''
+			if (tmux) {
+
+				// one tmux window per target, each in its shell dir
+				for (size_t i = 0; i < targets.n; i++) {
+					struct je_label *lab = &targets.lab[i];
+					if (!jump && target_repeats(&targets, 0, i)) continue;
+					char *dir = shell_quote(lab->dir);
+					if (jump) {
+						printf("tmux new-window -c %s\n", dir);
+					} else {
+						// tmux hands the window command to sh -c, so the path
+						// is quoted for that shell and the whole command again
+						// for the shell that evals this script
+						char *path = shell_quote(lab->path);
+						size_t len = strlen(lab->resolved) + 1 + strlen(path) + 1;
+						char *command = malloc(len);
+						if (!command) { perror("malloc"); exit(1); }
+						snprintf(command, len, "%s %s", lab->resolved, path);
+						char *quoted = shell_quote(command);
+
+						printf("tmux new-window -c %s %s\n", dir, quoted);
+
+						free(quoted);
+						free(command);
+						free(path);
+					}
+					free(dir);
+				}
 
-				if (AP_has_flag(je, "-j", "--jump")) {
+			} else {
 
-					printf("cd %s\n", quoted_dirstr);
+				const char *sep = "";
 
-				} else if (AP_has_flag(je, "-e", "--edit")) {
+				// the first target decides where the shell ends up
+				if (!edit) {
+					char *dir = shell_quote(targets.lab[0].dir);
+					printf("cd %s", dir);
+					free(dir);
+					sep = " && ";
+				}
 
-					printf("%s %s\n", default_editor, quoted_pathstr);
+				// one command per editor in the order they first show
+				// up, so targets sharing an editor open in one go
+				size_t n_editors = 0;
+				for (size_t i = 0; i < targets.n && !jump; i++) {
+					int seen = 0;
+					for (size_t j = 0; j < i; j++) {
+						if (!strcmp(targets.lab[j].resolved, targets.lab[i].resolved)) seen = 1;
+					}
+					if (!seen) n_editors++;
+				}
 
-				} else {
+				// editors open one after another, a terminal editor can't
+				// share the terminal and quitting one shouldn't skip the
+				// rest. Grouped so a failed cd still runs none of them
+				if (n_editors > 1) {
+					printf("%s{ ", sep);
+					sep = "";
+				}
 
-					printf("cd %s && %s %s\n", quoted_dirstr, default_editor, quoted_pathstr);
+				for (size_t i = 0; i < targets.n && !jump; i++) {
 
+					int seen = 0;
+					for (size_t j = 0; j < i; j++) {
+						if (!strcmp(targets.lab[j].resolved, targets.lab[i].resolved)) seen = 1;
+					}
+					if (seen) continue;
+
+					printf("%s%s", sep, targets.lab[i].resolved);
+					for (size_t j = i; j < targets.n; j++) {
+						if (strcmp(targets.lab[j].resolved, targets.lab[i].resolved)) continue;
+						if (target_repeats(&targets, i, j)) continue;
+						char *path = shell_quote(targets.lab[j].path);
+						printf(" %s", path);
+						free(path);
+					}
+					sep = "; ";
 				}
 
-				
-				free(valstr);
-				free(dirstr);
-				free(pathstr);
-				free(quoted_dirstr);
-				free(quoted_pathstr);
-				free(fetched_editor.dptr);
-				free(default_editor);
-			
+				if (n_editors > 1) printf("; }");
+
+				printf("\n");
 			}
 
 			// I love C
-			free(fetched.dptr);
+			for (size_t i = 0; i < targets.n; i++) {
+				label_free(&targets.lab[i]);
+			}
+			free(targets.lab);
+			meta_free(&meta);
+			PL_close(&layer);
 
 			break;
 		}
@@ -311,116 +1412,133 @@ int main(int argc, char **argv) {
 			}
 
 			size_t len = AP_len(head);
-			if (len > 2) {
+			if (len > 3) {
 				fprintf(stderr, "Error: too many arguments\n" SEE_HELP);
 				exit(EXIT_FAILURE);
 			}
+
+			// 'je list work/' only lists the work namespace
+			struct ap_arg *namespace = AP_get(head, 2);
+			char *prefix = namespace ? namespace_prefix(namespace->str) : strdup("");
+			if (!prefix) { perror("malloc"); exit(1); }
+			size_t prefix_len = strlen(prefix);
+
+			if (AP_has_flag(list, NULL, NULL) && !AP_has_flag(list, "-l", "--label")
+					&& !AP_has_flag(list, "-j", "--jump")
+					&& !AP_has_flag(list, "-d", "--directory")) { // if any other flag is present 
+				fprintf(stderr, "Error: option(s) for list not found\n");
+				exit(EXIT_FAILURE);
+			}
 			
-			// need to display current default editor at the top
-			// dont need to add null terminator because it was stored with one
-			datum default_editor_key = { (void*)"default-editor\0", 15 };
-			datum editor_fetched = gdbm_fetch(db, default_editor_key);
-			char *default_editor = malloc(editor_fetched.dsize);
-			memcpy(default_editor, editor_fetched.dptr, editor_fetched.dsize);
+			// need to display current settings at the top
+			struct je_meta meta;
+			meta_load(db, &meta);
+			const char *default_editor = meta_get(&meta, "default-editor");
+
+			printf("(L = Label), (JP = Jump Path), (SD = Shell Directory), (ED = Editor)\n");
+			printf("Default Editor: %s\n", default_editor ? default_editor : "");
+			for (int i = 0; i < meta.n; i++) {
+				if (!strncmp(meta.name[i], "ext:", 4)) {
+					printf("Extension Editor: %s -> %s\n", meta.name[i] + 4, meta.val[i]);
+				}
+			}
+			printf("\n");
 
-			printf("(L = Label), (JP = Jump Path), (SD = Shell Directory)\n");
-			printf("Default Editor: %s\n\n", default_editor);
+			size_t num_label = 0;
 
-			datum key = gdbm_firstkey(db);
+			// project labels come first since they win over
+			// personal labels, the blob is already sorted
+			struct pl_layer layer;
+			open_project_layer(je_cache_dir, &layer);
+
+			size_t project_from = PL_lower_bound(&layer, prefix);
+			size_t project_to = project_from;
+			while (project_to < PL_len(&layer)) {
+				const char *labelstr;
+				PL_get(&layer, project_to, &labelstr, NULL, NULL);
+				if (strncmp(labelstr, prefix, prefix_len)) break;
+				project_to++;
+			}
 
-			if (key.dptr == NULL) {
-				if(gdbm_errno == GDBM_ITEM_NOT_FOUND) {
-					fprintf(stderr, "Error: No default editor or jump labels in database.\n" SEE_HELP);
-					exit(EXIT_FAILURE);
-				} else {
-					fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
-					exit(EXIT_FAILURE);
-				}
+			if (project_to > project_from) {
+				printf("Project: %s\n\n", layer.root);
 			}
 
+			for (size_t i = project_from; i < project_to; i++) {
+				struct je_label lab = { .editor = "" };
+				const char *labelstr;
+				PL_get(&layer, i, &labelstr, (const char**)&lab.path, (const char**)&lab.dir);
+				print_label(list, labelstr, &lab, resolve_editor(&meta, &lab), "");
+				num_label++;
+			}
 
-			size_t num_label = 0;
-			int has_default_editor = 0;
+			if (project_to > project_from && !AP_has_flag(list, "-l", "--label")) {
+				printf("%sPersonal:\n\n", AP_has_flag(list, NULL, NULL) ? "\n" : "");
+			}
 
-			// maybe make this sort alphabetically later
-			while (key.dptr != NULL) {
+			// the sorted index gives alphabetical order and lets a
+			// namespace only touch its own labels
+			struct li_index index;
+			label_index_open(db, je_index_path, &index);
+
+			size_t from, to;
+			namespace_range(&index, prefix, &from, &to);
+
+			for (size_t i = from; i < to; i++) {
 
-				
-				/*
-				 * because the datum's pointer holds the raw
-				 * data without a null terminator, wee need to
-				 * malloc room at the end for '\0' when storing
-				*/
-				char *keystr = malloc(key.dsize + 1);
-				memcpy(keystr, key.dptr, key.dsize);
-				keystr[key.dsize] = '\0';
-
-				// fetched directory from key
+				const char *labelstr = LI_get(&index, i);
+				const char *note = PL_find(&layer, labelstr, NULL, NULL) ? " (hidden by project)" : "";
+
+				datum key = { (void*)labelstr, strlen(labelstr) };
 				datum fetched = gdbm_fetch(db, key); 
-				char *valstr = malloc(fetched.dsize + 1);
-				memcpy(valstr, fetched.dptr, fetched.dsize);
-				valstr[fetched.dsize] = '\0';
-
-				/*
-				 * since the jump path and the shell dir are stored in
-				 * the database as one string ie "jump/path/somefile.c shell/dir"
-				 * and separated by a space. We need to separate each path
-				 * at the space and store them in their own variables
-				 */
-				char *pattern = "^(.+):::(.+)$"; // split the two paths at the space
-				char *pathstr = get_matches(pattern, valstr, 1, 2);
-				char *dirstr = get_matches(pattern, valstr, 2, 2);
-
-
-				// because we are using the same database for storing the
-				// default-editor we need to not display it like other
-				// jump descriptors
-				if(!strcmp(keystr, "default-editor")) {
-					has_default_editor = 1;
+
+				if (fetched.dptr == NULL) {
+					if (gdbm_errno != GDBM_ITEM_NOT_FOUND) {
+						fprintf(stderr, "Error: %s\n", gdbm_db_strerror(db));
+						exit(EXIT_FAILURE);
+					}
+					continue; // removed by an older version of je
+				}
+
+				if (is_group_record(fetched)) {
+					print_group(list, labelstr, fetched, note);
 				} else {
-					num_label++;
-					if(AP_has_flag(list, "-l", "--label")) {
-						printf("%s, ", keystr);
-					} else if (AP_has_flag(list, "-j", "--jump")) {
-						printf("L: %s | JP: %s\n", keystr, pathstr);
-					} else if (AP_has_flag(list, "-d", "--directory")) {
-						printf("L: %s | SD: %s\n", keystr, dirstr);
-					} else if (AP_has_flag(list, NULL, NULL)) { // if any other flag is present 
-						fprintf(stderr, "Error: option(s) for list not found\n");
+					struct je_label lab;
+					if (label_decode(fetched, &lab) != 0) {
+						fprintf(stderr, "Error: label '%s' has a corrupt record\n", labelstr);
 						exit(EXIT_FAILURE);
-					} else if (!AP_has_flag(list, NULL, NULL)) { // if no flags are present
-					printf("L: %s \n"
-						   "├JP: %s\n"
-						   "└SD: %s\n\n"
-							, keystr, pathstr, dirstr);
 					}
+					print_label(list, labelstr, &lab,
+							lab.resolved ? lab.resolved : resolve_editor(&meta, &lab), note);
+					label_free(&lab);
 				}
+				num_label++;
 
-				free(keystr);
-				free(pathstr);
-				free(dirstr);
 				free(fetched.dptr);
-
-				datum oldkey = key;
-
-				key = gdbm_nextkey(db, oldkey);
-
-				free(oldkey.dptr);
-
 			}
 
+			LI_close(&index);
+
 			// extra new line so that things line up for this option
 			if(AP_has_flag(list, "-l", "--label")) {
 				printf("\n\n");
 			}
 			
-			// if there is a default editor but no added labels 
-			if(num_label == 0 && has_default_editor) {
+			// if there are settings but no added labels 
+			if(num_label == 0 && namespace) {
+				printf("je: Error\n"
+						" No jump labels under '%s'.\n"
+						" See 'je --help'\n", prefix);
+			} else if(num_label == 0) {
 				printf("je: Error\n"
 						" No jump labels in database.\n"
 						" See 'je --help'\n");
 			}
 
+			free(prefix);
+			PL_close(&layer);
+			meta_free(&meta);
+
 			break;
 		}
 
@@ -470,26 +1588,30 @@ int main(int argc, char **argv) {
 			}
 
 
-			// three colons '%s:::%s' separate the two paths in storage
-			// this makes it less likely to have problems parsing 
-			// paths on other operating systems that use spaces
-			//
-			// allocate exact buffer length for both strings
-			int needed = snprintf(NULL, 0, "%s:::%s", path->str, dirstr);
-			char *temp_concat = malloc(needed + 1);
-			if(!temp_concat) { perror("malloc"); exit(1); }
-			snprintf(temp_concat, needed + 1, "%s:::%s", path->str, dirstr);
-
 			datum key = { 
 				.dptr = (void*)label->str, 
 				.dsize = strlen(label->str) 
 			};
 
-			datum val = {
-				.dptr = (void*)temp_concat,
-				.dsize = strlen(temp_concat),
+			struct je_meta meta;
+			meta_load(db, &meta);
+
+			// cache the editor in the record so jumps only fetch once
+			struct je_label lab = {
+				.path = path->str,
+				.dir = dirstr,
+				.editor = "",
 			};
+			lab.resolved = (char*)resolve_editor(&meta, &lab);
 
+			datum val = label_encode(&lab);
+
+			if (insensitive_enabled(&meta)) {
+				fold_index_check(db, key, label->str);
+			}
+
+			struct li_source before;
+			db_source(db, 0, &before);
 			int store_return = gdbm_store(db, key, val, GDBM_INSERT);
 
 			if (store_return == -1) {
@@ -500,6 +1622,11 @@ int main(int argc, char **argv) {
 						"Use 'je rm <label>' first if you want to replace it\n",
 						label->str);
 			} else {
+				if (fold_index_add(db, label->str) > 0) {
+					fprintf(stderr, "Warning: label '%s' only differs in case from another label, "
+							"see 'je case-insensitive'\n", label->str);
+				}
+				label_index_insert(db, je_index_path, label->str, &before);
 				printf("Success\n"
 						" New Label: '%s'\n"
 						" Jump Path: '%s'\n"
@@ -508,8 +1635,108 @@ int main(int argc, char **argv) {
 			}
 
 			if (dirstr) free(dirstr);
-			free(temp_concat);
+			free(val.dptr);
+			meta_free(&meta);
+
+			break;
+		}
+
+		case CMD_WORKSPACE: { // adds a label that opens several targets
+
+			struct ap_arg *label = AP_get(head, 2);
+
+			if (label == NULL) {
+				fprintf(stderr, "Error: could not add workspace, no label provided\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			if (label->next == NULL) {
+				fprintf(stderr, "Error: could not add workspace, no members provided\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			datum key = { (void*)label->str, strlen(label->str) };
+
+			struct je_meta meta;
+			meta_load(db, &meta);
+			if (insensitive_enabled(&meta)) {
+				fold_index_check(db, key, label->str);
+			}
+
+			// tag every member now so jumps never have to stat
+			// anything to tell labels and paths apart
+			size_t len = 2, cap = BUF_SIZE;
+			char *buf = malloc(cap);
+			if (!buf) { perror("malloc"); exit(1); }
+			memcpy(buf, GROUP_TAG, 2);
+
+			AP_FOREACH(member, label->next) {
+
+				datum member_key = { (void*)member->str, strlen(member->str) };
+				char *dirstr = NULL;
+				const char *kind = "l";
+
+				if (!gdbm_exists(db, member_key)) {
 
+					struct stat st;
+					if (stat(member->str, &st) < 0) {
+						fprintf(stderr, "Error: workspace member '%s' is not a je label or a path\n",
+								member->str);
+						exit(EXIT_FAILURE);
+					}
+
+					kind = "p";
+					if (is_file(member->str)) {
+						// extract directory that file is in
+						dirstr = get_matches(".*\\/", member->str, 0, 0);
+					}
+					if (dirstr == NULL) dirstr = strdup(member->str);
+					if (!dirstr) { perror("malloc"); exit(1); }
+				}
+
+				size_t needed = 2 + strlen(member->str) + 1 + (dirstr ? strlen(dirstr) + 1 : 0);
+				while (len + needed > cap) {
+					cap *= 2;
+					buf = realloc(buf, cap);
+					if (!buf) { perror("realloc"); exit(1); }
+				}
+
+				char *p = stpcpy(buf + len, kind) + 1;
+				p = stpcpy(p, member->str) + 1;
+				if (dirstr) p = stpcpy(p, dirstr) + 1;
+				len = p - buf;
+
+				free(dirstr);
+			}
+
+			datum val = { .dptr = buf, .dsize = len };
+
+			struct li_source before;
+			db_source(db, 0, &before);
+			int store_return = gdbm_store(db, key, val, GDBM_INSERT);
+
+			if (store_return == -1) {
+				fprintf(stderr, "%s: could not store value into database\n", 
+						gdbm_strerror(gdbm_errno));
+			} else if (store_return == 1) {
+				printf("Error: cound not add workspace '%s' because it already exist. "
+						"Use 'je rm <label>' first if you want to replace it\n",
+						label->str);
+			} else {
+				if (fold_index_add(db, label->str) > 0) {
+					fprintf(stderr, "Warning: label '%s' only differs in case from another label, "
+							"see 'je case-insensitive'\n", label->str);
+				}
+				label_index_insert(db, je_index_path, label->str, &before);
+				printf("Success\n"
+						" New Workspace: '%s'\n"
+						" Members: ", label->str);
+				group_print(stdout, val);
+				printf("\n");
+			}
+
+			free(buf);
+			meta_free(&meta);
 			break;
 		}
 
@@ -522,13 +1749,70 @@ int main(int argc, char **argv) {
 				exit(EXIT_FAILURE);
 			}
 
+			if (label == NULL) {
+				fprintf(stderr, "Error: could not remove label, no label provided\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			// remove a whole namespace with one range of the index
+			if (AP_has_flag(remove, "-r", "--recursive")) {
+
+				char *prefix = namespace_prefix(label->str);
+
+				struct li_index index;
+				label_index_open(db, je_index_path, &index);
+
+				size_t from, to;
+				namespace_range(&index, prefix, &from, &to);
+
+				if (from == to) {
+					fprintf(stderr, "Error: could not remove labels, none found under '%s'\n", prefix);
+					exit(EXIT_FAILURE);
+				}
+
+				size_t removed = 0;
+				for (size_t i = from; i < to; i++) {
+					const char *labelstr = LI_get(&index, i);
+					datum label_key = { (void*)labelstr, strlen(labelstr) };
+					if (gdbm_delete(db, label_key) == 0) {
+						fold_index_remove(db, labelstr);
+						removed++;
+					} else if (gdbm_errno != GDBM_ITEM_NOT_FOUND) {
+						fprintf(stderr, "Error: could not remove label '%s': %s\n",
+								labelstr, gdbm_db_strerror(db));
+					}
+				}
+
+				// a label that was not there means the index was off,
+				// build it from the database instead of trusting it
+				int rc;
+				if (removed == to - from) {
+					struct li_source after;
+					db_source(db, 1, &after);
+					rc = LI_remove_range(je_index_path, from, to, &after);
+				} else {
+					rc = label_index_build(db, je_index_path);
+				}
+				LI_close(&index);
+				if (rc < 0) label_index_failed();
+
+				printf("Success: %zu jump labels under '%s' removed\n", removed, prefix);
+
+				free(prefix);
+				break;
+			}
+
 			datum label_key = { (void*)label->str, strlen(label->str) };
 
+			struct li_source before;
+			db_source(db, 0, &before);
 			int delete_return = gdbm_delete(db, label_key);
 			if (delete_return == -1) {
 				fprintf(stderr, "Error: could not remove label '%s', not found in database\n",
 						label->str);
 			} else {
+				fold_index_remove(db, label->str);
+				label_index_remove(db, je_index_path, label->str, &before);
 				printf("Success: jump label '%s' removed\n", label->str);
 			}
 
@@ -536,6 +1820,52 @@ int main(int argc, char **argv) {
 
 		}
 
+		case CMD_INSENSITIVE: { // opt in to case insensitive labels
+
+			struct ap_arg *mode = AP_get(head, 2);
+
+			if (num_args > 3) {
+				fprintf(stderr, "Error: too many arguments\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			struct je_meta meta;
+			meta_load(db, &meta);
+
+			if (mode == NULL) {
+				printf("case-insensitive: %s\n", insensitive_enabled(&meta) ? "on" : "off");
+				meta_free(&meta);
+				break;
+			}
+
+			int enable;
+			if (!strcmp(mode->str, "on")) {
+				enable = 1;
+			} else if (!strcmp(mode->str, "off")) {
+				enable = 0;
+			} else {
+				fprintf(stderr, "Error: expected 'on' or 'off', got '%s'\n" SEE_HELP, mode->str);
+				exit(EXIT_FAILURE);
+			}
+
+			// labels added by older versions of je are not in the
+			// fold index yet, turning the mode on picks them up
+			if (enable) fold_index_rebuild(db);
+
+			meta_set(&meta, "case-insensitive", enable ? "1" : NULL);
+
+			if (meta_store(db, &meta) == -1) {
+				fprintf(stderr, "%s: could not store value into database\n", 
+						gdbm_strerror(gdbm_errno));
+			} else {
+				printf("Success: case-insensitive labels turned %s\n", mode->str);
+			}
+
+			meta_free(&meta);
+			break;
+
+		}
+
 		case CMD_EDITOR: { // set/change default editor
 
 			struct ap_arg *editor = AP_get(head, 2);
@@ -545,17 +1875,170 @@ int main(int argc, char **argv) {
 				exit(EXIT_FAILURE);
 			}
 
-			datum default_editor_key = { (void*)"default-editor\0", 15 };
-			datum default_editor_val = { (void*)editor->str, strlen(editor->str) };
+			if (editor == NULL) {
+				fprintf(stderr, "Error: no editor provided\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			struct je_meta meta;
+			meta_load(db, &meta);
+			meta_set(&meta, "default-editor", editor->str);
 
-			int store_return = gdbm_store(db, default_editor_key, default_editor_val, GDBM_REPLACE);
-			if (store_return == -1) {
+			if (meta_store(db, &meta) == -1) {
 				fprintf(stderr, "%s: could not store value into database\n", 
 						gdbm_strerror(gdbm_errno));
 			} else {
+				relabel_all(db, &meta);
 				printf("Success: saving '%s' as default editor\n", editor->str);
 			}
 
+			meta_free(&meta);
+			break;
+
+		}
+
+		case CMD_LABEL_EDITOR: { // per label editor override
+
+			struct ap_arg *label = AP_get(head, 2);
+			struct ap_arg *editor = AP_get(head, 3);
+
+			if (num_args > 4) {
+				fprintf(stderr, "Error: too many arguments\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			if (label == NULL) {
+				fprintf(stderr, "Error: no label provided\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			datum label_key = { (void*)label->str, strlen(label->str) };
+			datum fetched = gdbm_fetch(db, label_key);
+
+			if (fetched.dptr == NULL) {
+				fprintf(stderr, "Error: \'%s\' is not a je label.\n", label->str);
+				exit(EXIT_FAILURE);
+			}
+
+			if (is_group_record(fetched)) {
+				fprintf(stderr, "Error: '%s' is a workspace, set editors on its members\n", label->str);
+				exit(EXIT_FAILURE);
+			}
+
+			struct je_label lab;
+			if (label_decode(fetched, &lab) != 0) {
+				fprintf(stderr, "Error: label '%s' has a corrupt record\n", label->str);
+				exit(EXIT_FAILURE);
+			}
+
+			// leaving out the editor goes back to the default
+			free(lab.editor);
+			lab.editor = strdup(editor ? editor->str : "");
+			if (!lab.editor) { perror("malloc"); exit(1); }
+
+			struct je_meta meta;
+			meta_load(db, &meta);
+			free(lab.resolved);
+			lab.resolved = strdup(resolve_editor(&meta, &lab));
+			if (!lab.resolved) { perror("malloc"); exit(1); }
+
+			datum val = label_encode(&lab);
+			if (gdbm_store(db, label_key, val, GDBM_REPLACE) == -1) {
+				fprintf(stderr, "%s: could not store value into database\n", 
+						gdbm_strerror(gdbm_errno));
+			} else if (editor) {
+				printf("Success: label '%s' opens with '%s'\n", label->str, editor->str);
+			} else {
+				printf("Success: label '%s' opens with '%s'\n", label->str, lab.resolved);
+			}
+
+			free(val.dptr);
+			free(fetched.dptr);
+			label_free(&lab);
+			meta_free(&meta);
+			break;
+
+		}
+
+		case CMD_EXT_EDITOR: { // extension -> editor mapping
+
+			struct ap_arg *ext = AP_get(head, 2);
+			struct ap_arg *editor = AP_get(head, 3);
+
+			if (num_args > 4) {
+				fprintf(stderr, "Error: too many arguments\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			if (ext == NULL) {
+				fprintf(stderr, "Error: no extension provided\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			// 'md' and '.md' mean the same thing
+			char name[BUF_SIZE];
+			int char_written = snprintf(name, BUF_SIZE, "ext:%s%s",
+					ext->str[0] == '.' ? "" : ".", ext->str);
+			assert(char_written < BUF_SIZE);
+
+			struct je_meta meta;
+			meta_load(db, &meta);
+			meta_set(&meta, name, editor ? editor->str : NULL);
+
+			if (meta_store(db, &meta) == -1) {
+				fprintf(stderr, "%s: could not store value into database\n", 
+						gdbm_strerror(gdbm_errno));
+			} else {
+				relabel_all(db, &meta);
+				if (editor) {
+					printf("Success: '%s' files open with '%s'\n", name + 4, editor->str);
+				} else {
+					printf("Success: '%s' files open with the default editor\n", name + 4);
+				}
+			}
+
+			meta_free(&meta);
+			break;
+
+		}
+
+		case CMD_STATS: { // usage, latency and store health
+
+			struct ap_arg *stats_arg = AP_get(head, 1);
+
+			if (num_args > 2) {
+				fprintf(stderr, "Error: too many arguments\n" SEE_HELP);
+				exit(EXIT_FAILURE);
+			}
+
+			// fragmentation is what gdbm_delete leaves behind, the
+			// file keeps its size while live data shrinks
+			struct st_store store = { 0 };
+
+			struct stat st;
+			if (stat(je_gdbm_dir, &st) == 0) store.file_size = st.st_size;
+
+			datum key = gdbm_firstkey(db);
+			while (key.dptr != NULL) {
+				datum fetched = gdbm_fetch(db, key);
+				store.records++;
+				if (is_label_key(key)) store.labels++;
+				store.live_bytes += key.dsize + (fetched.dptr ? fetched.dsize : 0);
+				free(fetched.dptr);
+
+				datum oldkey = key;
+				key = gdbm_nextkey(db, oldkey);
+				free(oldkey.dptr);
+			}
+
+#if GDBM_VERSION_MAJOR > 1 || (GDBM_VERSION_MAJOR == 1 && GDBM_VERSION_MINOR >= 13)
+			size_t buckets;
+			if (gdbm_bucket_count(db, &buckets) == 0) store.buckets = buckets;
+#endif
+
+			ST_print(stdout, stats, cmd_names, sizeof(cmd_names) / sizeof(cmd_names[0]),
+					&store, AP_has_flag(stats_arg, NULL, "--json"));
+
 			break;
 
 		}
@@ -564,19 +2047,35 @@ int main(int argc, char **argv) {
 						 
 			fprintf(stdout, "je (j)ump (e)dit help page\n\n"
 					"Usage:\n"
-					"   je [-j|-e] <label> ........... jump to labeled jump path and open editor\n"
-					"                                  see example (5).\n"
+					"   je [-j|-e|-t] <label> ... .... jump to labeled jump path and open editor\n"
+					"                                  see example (5) and (9).\n"
 					"      -j | --jump ............... [jump] only jump to label directory.\n"
-					"      -e | --edit ............... [edit] only edit at label path.\n\n"
+					"      -e | --edit ............... [edit] only edit at label path.\n"
+					"      -t | --tmux ............... [tmux] one tmux window per label.\n"
+					"      --no-prefetch ............. don't warm the file cache for the editor.\n\n"
 					"   je add <label> <path> <dir> .  adds user label and jump path with optional\n"
 					"                                  shell directory. See description (4).\n\n"
-					"   je rm  <label> ............... removes a user jump label.\n\n"
+					"   je workspace <label> <member> ...  adds a label that opens every\n"
+					"                                  member, a member is a label or a path.\n\n"
+					"   je rm [-r] <label> ........... removes a user jump label.\n"
+					"      -r | --recursive .......... [recursive] removes every label under\n"
+					"                                  a namespace i.e. 'je rm -r work/'.\n\n"
 					"   je default-editor <editor> ... specifies default editor\n" 
 					"                                  when opening paths.\n\n"
-					"   je list [-l|-j|-d]............ displays labels with jumps and directories\n" 
+					"   je label-editor <label> <editor>  opens one label with its own editor,\n"
+					"                                  leave out editor to go back to default.\n\n"
+					"   je ext-editor <.ext> <editor>  opens files ending in .ext with editor,\n"
+					"                                  leave out editor to remove. See example (8).\n\n"
+					"   je case-insensitive <on|off> . lets labels match regardless of case\n"
+					"                                  i.e. 'je MyProj' finds 'myproj'.\n\n"
+					"   je list [-l|-j|-d] [ns/] ..... displays labels with jumps and directories,\n" 
+					"                                  only under namespace ns/ if given\n"
 					"      -l | --label ...............[label] labels in oneline\n"
 					"      -j | --jump ................[jump] only labels with jump\n"
 					"      -d | --directory ...........[directory] only labels with directories\n\n"
+					"   je stats [--json] ............ prints command counts (failed ones\n"
+					"                                  too), latency percentiles and\n"
+					"                                  database health.\n\n"
 					"   je --help .................... prints help.\n\n"
 					"Description:\n"
 					"   1) je (jump edit) allows user to save a jump path to an \n"
@@ -617,6 +2116,26 @@ int main(int argc, char **argv) {
 					"   7) Remove label user does not want anymore\n\n"
 					"      'je rm .bashrc\n"
 					"      'je rm myproj\n\n"
+					"   8) Pick editors per label or per file extension, a label editor\n"
+					"      wins over an extension editor which wins over the default\n\n"
+					"      'je ext-editor .md typora'\n"
+					"      'je label-editor myproj code'\n\n"
+					"   9) Open several labels at once, the shell ends up in the first\n"
+					"      label's directory and files sharing an editor open together.\n"
+					"      Different editors open one after another\n\n"
+					"      'je myproj bash'\n"
+					"      'je workspace daily myproj bash ~/notes.md'\n"
+					"      'je daily'\n"
+					"      'je -t daily' // one tmux window per member instead\n\n"
+					"   10) Group labels into namespaces with a '/' and work on the whole group\n\n"
+					"      'je add work/api ~/work/api'\n"
+					"      'je list work/'\n"
+					"      'je rm -r work/'\n\n"
+					"   11) Share labels with a project by checking in a .je file at its\n"
+					"      root, one '<label> <path> [dir]' per line with paths relative\n"
+					"      to the root. Inside the project its labels win over yours\n\n"
+					"      'echo \"api src/api/main.c .\" >> ~/myproj/.je'\n"
+					"      'cd ~/myproj/src && je api'\n\n"
 					"Important Information:\n"
 					"   - je was build for max typing efficiency, thus the base\n"
 					"     command 'je <label>' will be blocked by any sub \n"
@@ -632,8 +2151,13 @@ int main(int argc, char **argv) {
 	}
 
 
+	ST_record(stats, ST_PHASE_COMMAND, ST_now_us() - run.command_start_us);
+	run.command_start_us = 0;
+
 	AP_free(head);
 	gdbm_close(db);
+
+	run.finished = 1; // record_run does the rest on the way out
 	return (EXIT_SUCCESS);
 
 }
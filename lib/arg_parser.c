@@ -88,8 +88,6 @@ int AP_has_flag(struct ap_arg *arg, char *flag_short, char *flag_long) {
 		if(flag_short == NULL && flag_long == NULL) {
 			return 1;
 		}
-
-		return 0;
 	}
 
 	return 0;
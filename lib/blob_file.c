@@ -0,0 +1,63 @@
+/**
+ * Whole file blobs for je
+ *
+ * Readers mmap a blob and trust nothing in it until its own
+ * header checks out. Writers never touch a blob in place, they
+ * write a temp file next to it and rename it over the old one,
+ * so a concurrent je maps either the old blob or the new one and
+ * never a half written one
+ */
+
+#include "../include/blob_file.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void *BF_map(const char *path, size_t min_size, size_t *out_size) {
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < min_size) {
+		close(fd);
+		return NULL;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return NULL;
+
+	*out_size = st.st_size;
+	return map;
+}
+
+void BF_unmap(void *map, size_t size) {
+	if (map) munmap(map, size);
+}
+
+int BF_write(const char *path, const void *buf, size_t size) {
+
+	size_t len = strlen(path) + sizeof(".XXXXXX");
+	char *tmp_path = malloc(len);
+	if (!tmp_path) return -1;
+	snprintf(tmp_path, len, "%s.XXXXXX", path);
+
+	int fd = mkstemp(tmp_path);
+	if (fd < 0) { free(tmp_path); return -1; }
+
+	ssize_t written = write(fd, buf, size);
+	close(fd);
+
+	int rc = 0;
+	if (written != (ssize_t)size || rename(tmp_path, path) < 0) {
+		unlink(tmp_path);
+		rc = -1;
+	}
+
+	free(tmp_path);
+	return rc;
+}
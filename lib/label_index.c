@@ -0,0 +1,152 @@
+/**
+ * Ordered label index for je
+ *
+ * gdbm hands keys back in hash order, so anything that wants a
+ * range of labels would have to read every record. This keeps a
+ * sorted copy of the label names next to the database. Lookups
+ * mmap it and binary search, writes rebuild the whole blob.
+ * Writers are serialized by the gdbm writer lock je holds. The
+ * header keeps the mtime and size of the database file it was
+ * written against, so an index that missed a write is noticed
+ * with one fstat and rebuilt instead of trusted
+ */
+
+#include "../include/label_index.h"
+#include "../include/blob_file.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LI_MAGIC "JEI3"
+
+int LI_open(const char *path, struct li_index *out_index) {
+
+	memset(out_index, 0, sizeof(*out_index));
+
+	size_t size;
+	void *map = BF_map(path, sizeof(struct li_header), &size);
+	if (map == NULL) return -1;
+
+	const struct li_header *header = map;
+	size_t offsets_end = sizeof(struct li_header) + (size_t)header->count * sizeof(uint32_t);
+
+	if (memcmp(header->magic, LI_MAGIC, 4) || offsets_end > size) {
+		BF_unmap(map, size);
+		return -1;
+	}
+
+	out_index->map = map;
+	out_index->size = size;
+	out_index->count = header->count;
+	out_index->source = header->source;
+	out_index->offsets = (const uint32_t*)((const char*)map + sizeof(struct li_header));
+	out_index->strings = (const char*)map + offsets_end;
+	return 0;
+}
+
+void LI_close(struct li_index *index) {
+	BF_unmap(index->map, index->size);
+	memset(index, 0, sizeof(*index));
+}
+
+size_t LI_lower_bound(struct li_index *index, const char *label) {
+	size_t lo = 0, hi = index->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (strcmp(index->strings + index->offsets[mid], label) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+const char *LI_get(struct li_index *index, size_t element) {
+	return index->strings + index->offsets[element];
+}
+
+size_t LI_len(struct li_index *index) {
+	return index->count;
+}
+
+int LI_write(const char *path, const char **labels, size_t n_labels,
+		const struct li_source *source) {
+
+	size_t strings_len = 0;
+	for (size_t i = 0; i < n_labels; i++) {
+		strings_len += strlen(labels[i]) + 1;
+	}
+
+	size_t size = sizeof(struct li_header) + n_labels * sizeof(uint32_t) + strings_len;
+	char *blob = calloc(1, size);
+	if (!blob) return -1;
+
+	struct li_header *header = (struct li_header*)blob;
+	uint32_t *offsets = (uint32_t*)(blob + sizeof(struct li_header));
+	char *strings = (char*)(offsets + n_labels);
+	char *p = strings;
+
+	memcpy(header->magic, LI_MAGIC, 4);
+	header->count = n_labels;
+	header->source = *source;
+	for (size_t i = 0; i < n_labels; i++) {
+		offsets[i] = p - strings;
+		p = stpcpy(p, labels[i]) + 1;
+	}
+
+	int rc = BF_write(path, blob, size);
+	free(blob);
+	return rc;
+}
+
+int LI_insert(const char *path, const char *label, const struct li_source *source) {
+
+	struct li_index index;
+	LI_open(path, &index); // missing index is the same as empty
+
+	size_t at = LI_lower_bound(&index, label);
+	int present = at < index.count && !strcmp(LI_get(&index, at), label);
+
+	const char **labels = malloc((index.count + 1) * sizeof(char*));
+	if (!labels) { LI_close(&index); return -1; }
+
+	size_t n = 0;
+	for (size_t i = 0; i < at; i++) labels[n++] = LI_get(&index, i);
+	if (!present) labels[n++] = label; // still rewritten for the new source
+	for (size_t i = at; i < index.count; i++) labels[n++] = LI_get(&index, i);
+
+	int rc = LI_write(path, labels, n, source);
+
+	free(labels);
+	LI_close(&index);
+	return rc;
+}
+
+int LI_remove_range(const char *path, size_t from, size_t to, const struct li_source *source) {
+
+	struct li_index index;
+	if (LI_open(path, &index) < 0) return -1;
+
+	if (to > index.count) to = index.count;
+	if (from >= to) {
+		LI_close(&index);
+		return 0;
+	}
+
+	const char **labels = malloc(index.count * sizeof(char*));
+	if (!labels) { LI_close(&index); return -1; }
+
+	size_t n = 0;
+	for (size_t i = 0; i < index.count; i++) {
+		if (i < from || i >= to) labels[n++] = LI_get(&index, i);
+	}
+
+	int rc = LI_write(path, labels, n, source);
+
+	free(labels);
+	LI_close(&index);
+	return rc;
+}
+
+int LI_same_source(const struct li_source *a, const struct li_source *b) {
+	return a->mtime_sec == b->mtime_sec
+		&& a->mtime_nsec == b->mtime_nsec
+		&& a->size == b->size;
+}
@@ -0,0 +1,142 @@
+/**
+ * Target pre-warming for je
+ *
+ * On a cold cache (NFS, a big repo opened as a directory) the
+ * editor's first paint waits on the filesystem, not on je. Once je
+ * knows where the editor and shell are going it forks a child that
+ * asks the kernel to read the file ahead and stats the first levels
+ * of the directory so their dentries and inodes are warm by the time
+ * the editor asks. The child is detached from je's stdout, so the
+ * shell reading the printed script never waits on it, and it stops
+ * when its time budget or entry budget runs out
+ */
+
+#include "../include/prefetch.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+struct pf_budget {
+	uint64_t deadline_ms;
+	size_t entries_left;
+};
+
+static uint64_t pf_now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int pf_spent(struct pf_budget *budget) {
+	return budget->entries_left == 0 || pf_now_ms() >= budget->deadline_ms;
+}
+
+static void pf_file(int fd, off_t size) {
+
+	off_t len = size < PF_MAX_BYTES ? size : PF_MAX_BYTES;
+
+#if defined(POSIX_FADV_WILLNEED)
+	posix_fadvise(fd, 0, len, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+	struct radvisory advice = { .ra_offset = 0, .ra_count = len };
+	fcntl(fd, F_RDADVISE, &advice);
+#endif
+}
+
+static void pf_dir(int dir_fd, int depth, struct pf_budget *budget) {
+
+	DIR *dir = fdopendir(dir_fd);
+	if (dir == NULL) {
+		close(dir_fd);
+		return;
+	}
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL && !pf_spent(budget)) {
+
+		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) continue;
+
+		// the stat is what pulls the inode in
+		struct stat st;
+		budget->entries_left--;
+		if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0) continue;
+
+		if (S_ISDIR(st.st_mode) && depth < PF_MAX_DEPTH) {
+			int child_fd = openat(dirfd(dir), entry->d_name, O_RDONLY | O_DIRECTORY);
+			if (child_fd >= 0) pf_dir(child_fd, depth + 1, budget);
+		}
+	}
+
+	closedir(dir);
+}
+
+static void pf_warm(const char **paths, size_t n_paths) {
+
+	struct pf_budget budget = {
+		.deadline_ms = pf_now_ms() + PF_BUDGET_MS,
+		.entries_left = PF_MAX_ENTRIES,
+	};
+
+	for (size_t i = 0; i < n_paths && !pf_spent(&budget); i++) {
+
+		// a FIFO would block the open until someone writes to it
+		int fd = open(paths[i], O_RDONLY | O_NONBLOCK);
+		if (fd < 0) continue;
+
+		struct stat st;
+		if (fstat(fd, &st) < 0) {
+			close(fd);
+		} else if (S_ISDIR(st.st_mode)) {
+			pf_dir(fd, 1, &budget); // closes fd
+		} else {
+			if (S_ISREG(st.st_mode)) pf_file(fd, st.st_size);
+			close(fd);
+		}
+	}
+}
+
+void PF_spawn(const char **paths, size_t n_paths) {
+
+	if (n_paths == 0) return;
+
+	pid_t pid = fork();
+	if (pid < 0) return; // prefetch is only a hint
+
+	if (pid > 0) {
+		// the middle child exits right away, reap it so
+		// the warming child ends up owned by init
+		waitpid(pid, NULL, 0);
+		return;
+	}
+
+	setsid();
+	if (fork() != 0) _exit(0);
+
+	// the shell reads je's stdout until every copy of it is
+	// closed, so the child must not hold on to it
+	int null_fd = open("/dev/null", O_RDWR);
+	if (null_fd >= 0) {
+		dup2(null_fd, STDIN_FILENO);
+		dup2(null_fd, STDOUT_FILENO);
+		dup2(null_fd, STDERR_FILENO);
+		if (null_fd > STDERR_FILENO) close(null_fd);
+	}
+
+	// same for everything else je had open, a copy of the
+	// database fd would keep its flock held after je exits
+	long max_fd = sysconf(_SC_OPEN_MAX);
+	if (max_fd < 0 || max_fd > 1024) max_fd = 1024;
+	for (int fd = STDERR_FILENO + 1; fd < max_fd; fd++) close(fd);
+
+	// the budget is only checked between calls, this ends one
+	// that never comes back i.e. a stuck network mount
+	alarm(PF_BUDGET_MS / 1000 + 1);
+
+	pf_warm(paths, n_paths);
+	_exit(0);
+}
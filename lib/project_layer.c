@@ -0,0 +1,409 @@
+/**
+ * Project label layers for je
+ *
+ * A project keeps its labels in a plain text .je file at its root,
+ * one label per line:
+ *
+ *     # label   path              shell dir (optional)
+ *     api       src/api/main.c    .
+ *     docs      docs
+ *
+ * Relative paths are relative to the project root. The first time
+ * a .je is used it is compiled into a sorted blob in the cache dir
+ * so every later lookup is an mmap and a binary search
+ */
+
+#include "../include/project_layer.h"
+#include "../include/blob_file.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PL_MAGIC "JEC1"
+#define PL_LINE_SIZE 4096
+
+// found project roots, a fixed table of slots picked by cwd hash
+#define PL_ROOTS_FILE "roots"
+#define PL_ROOT_SLOTS 64
+
+struct pl_root_slot {
+	int64_t cwd_mtime_sec;
+	int64_t cwd_mtime_nsec;
+	char paths[1008]; // "<cwd>\0<root>\0"
+};
+
+// one parsed line of a .je file before it is laid out
+struct pl_line {
+	char *label;
+	char *path;
+	char *dir;
+	size_t line_no;
+};
+
+// FNV-1a, names blobs and picks root slots
+static uint64_t pl_hash(const char *str) {
+	uint64_t hash = 1469598103934665603ULL;
+	for (const char *c = str; *c; c++) {
+		hash ^= (unsigned char)*c;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static char *pl_join(const char *root, const char *path) {
+
+	if (path[0] == '/') return strdup(path);
+
+	// "." means the root itself
+	if (!strcmp(path, ".")) return strdup(root);
+
+	size_t len = strlen(root) + 1 + strlen(path) + 1;
+	char *joined = malloc(len);
+	if (!joined) return NULL;
+	snprintf(joined, len, "%s/%s", root, path);
+	return joined; // caller must free
+}
+
+// the shell dir je add would infer for path
+static char *pl_infer_dir(const char *path) {
+
+	struct stat st;
+	if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) return strdup(path);
+
+	const char *slash = strrchr(path, '/');
+	if (slash == NULL) return strdup(".");
+
+	size_t len = slash - path + 1; // keep the trailing '/' like je add does
+	char *dir = malloc(len + 1);
+	if (!dir) return NULL;
+	memcpy(dir, path, len);
+	dir[len] = '\0';
+	return dir; // caller must free
+}
+
+static void pl_lines_free(struct pl_line *lines, size_t n_lines) {
+	for (size_t i = 0; i < n_lines; i++) {
+		free(lines[i].label);
+		free(lines[i].path);
+		free(lines[i].dir);
+	}
+	free(lines);
+}
+
+static int pl_line_cmp(const void *a, const void *b) {
+	const struct pl_line *la = a, *lb = b;
+	int cmp = strcmp(la->label, lb->label);
+	if (cmp) return cmp;
+	// keep the first line of a duplicated label
+	return (la->line_no > lb->line_no) - (la->line_no < lb->line_no);
+}
+
+static int pl_compile(const char *je_file, const char *root, struct stat *src_st,
+		const char *out_path) {
+
+	FILE *fp = fopen(je_file, "r");
+	if (!fp) return -1;
+
+	size_t n_lines = 0, cap = 16;
+	struct pl_line *lines = malloc(cap * sizeof(struct pl_line));
+	if (!lines) { fclose(fp); return -1; }
+
+	char buf[PL_LINE_SIZE];
+	size_t line_no = 0;
+	while (fgets(buf, sizeof(buf), fp)) {
+
+		line_no++;
+
+		char *comment = strchr(buf, '#');
+		if (comment) *comment = '\0';
+
+		char *save = NULL;
+		char *label = strtok_r(buf, " \t\r\n", &save);
+		char *path = strtok_r(NULL, " \t\r\n", &save);
+		char *dir = strtok_r(NULL, " \t\r\n", &save);
+		char *extra = strtok_r(NULL, " \t\r\n", &save);
+
+		if (label == NULL) continue; // blank line
+
+		if (path == NULL || extra != NULL) {
+			fprintf(stderr, "Warning: %s:%zu expected '<label> <path> [dir]', line skipped\n",
+					je_file, line_no);
+			continue;
+		}
+
+		if (n_lines == cap) {
+			cap *= 2;
+			struct pl_line *grown = realloc(lines, cap * sizeof(struct pl_line));
+			if (!grown) { fclose(fp); pl_lines_free(lines, n_lines); return -1; }
+			lines = grown;
+		}
+
+		struct pl_line *line = &lines[n_lines++];
+		line->line_no = line_no;
+		line->label = strdup(label);
+		line->path = pl_join(root, path);
+		line->dir = dir ? pl_join(root, dir) : (line->path ? pl_infer_dir(line->path) : NULL);
+		if (!line->label || !line->path || !line->dir) {
+			fclose(fp);
+			pl_lines_free(lines, n_lines);
+			return -1;
+		}
+	}
+	fclose(fp);
+
+	qsort(lines, n_lines, sizeof(struct pl_line), pl_line_cmp);
+
+	// lay out header, entries and strings in one buffer
+	size_t strings_len = strlen(root) + 1;
+	for (size_t i = 0; i < n_lines; i++) {
+		strings_len += strlen(lines[i].label) + 1;
+		strings_len += strlen(lines[i].path) + 1;
+		strings_len += strlen(lines[i].dir) + 1;
+	}
+
+	size_t size = sizeof(struct pl_header) + n_lines * sizeof(struct pl_entry) + strings_len;
+	char *blob = calloc(1, size);
+	if (!blob) { pl_lines_free(lines, n_lines); return -1; }
+
+	struct pl_header *header = (struct pl_header*)blob;
+	struct pl_entry *entries = (struct pl_entry*)(blob + sizeof(struct pl_header));
+	char *strings = (char*)(entries + n_lines);
+	char *p = strings;
+
+	memcpy(header->magic, PL_MAGIC, 4);
+	header->src_mtime_sec = PL_MTIME(src_st).tv_sec;
+	header->src_mtime_nsec = PL_MTIME(src_st).tv_nsec;
+	header->src_size = src_st->st_size;
+	header->root = p - strings;
+	p = stpcpy(p, root) + 1;
+
+	uint32_t count = 0;
+	for (size_t i = 0; i < n_lines; i++) {
+
+		if (count > 0 && !strcmp(lines[i].label, strings + entries[count - 1].label)) {
+			fprintf(stderr, "Warning: %s:%zu label '%s' is already defined, line skipped\n",
+					je_file, lines[i].line_no, lines[i].label);
+		} else {
+			entries[count].label = p - strings;
+			p = stpcpy(p, lines[i].label) + 1;
+			entries[count].path = p - strings;
+			p = stpcpy(p, lines[i].path) + 1;
+			entries[count].dir = p - strings;
+			p = stpcpy(p, lines[i].dir) + 1;
+			count++;
+		}
+	}
+	pl_lines_free(lines, n_lines);
+
+	// skipped duplicates leave the string table short, move it
+	// up so it sits right behind the entries that were kept
+	header->count = count;
+	size_t used = p - strings;
+	memmove(entries + count, strings, used);
+	size = sizeof(struct pl_header) + count * sizeof(struct pl_entry) + used;
+
+	int rc = BF_write(out_path, blob, size);
+	free(blob);
+	return rc;
+}
+
+static int pl_map(const char *blob_path, const char *root, struct stat *src_st,
+		struct pl_layer *layer) {
+
+	size_t size;
+	void *map = BF_map(blob_path, sizeof(struct pl_header), &size);
+	if (map == NULL) return -1;
+
+	const struct pl_header *header = map;
+	size_t entries_end = sizeof(struct pl_header) + (size_t)header->count * sizeof(struct pl_entry);
+
+	int fresh = !memcmp(header->magic, PL_MAGIC, 4)
+		&& entries_end < size
+		&& header->src_mtime_sec == PL_MTIME(src_st).tv_sec
+		&& header->src_mtime_nsec == PL_MTIME(src_st).tv_nsec
+		&& header->src_size == src_st->st_size;
+
+	const char *strings = (const char*)map + entries_end;
+
+	// two roots hashing to the same blob name
+	if (fresh && strcmp(strings + header->root, root)) fresh = 0;
+
+	if (!fresh) {
+		BF_unmap(map, size);
+		return -1;
+	}
+
+	layer->map = map;
+	layer->size = size;
+	layer->count = header->count;
+	layer->entries = (const struct pl_entry*)((const char*)map + sizeof(struct pl_header));
+	layer->strings = strings;
+	layer->root = strings + header->root;
+	return 0;
+}
+
+int PL_open(const char *root, const char *cache_dir, struct pl_layer *out_layer) {
+
+	memset(out_layer, 0, sizeof(*out_layer));
+
+	char je_file[PL_LINE_SIZE];
+	if (snprintf(je_file, sizeof(je_file), "%s/%s", root, PL_FILE_NAME) >= (int)sizeof(je_file)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	struct stat src_st;
+	if (stat(je_file, &src_st) < 0) return -1;
+
+	char blob_path[PL_LINE_SIZE];
+	if (snprintf(blob_path, sizeof(blob_path), "%s/%016llx.jec",
+				cache_dir, (unsigned long long)pl_hash(root)) >= (int)sizeof(blob_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	if (pl_map(blob_path, root, &src_st, out_layer) == 0) return 0;
+
+	mkdir(cache_dir, 0700);
+	if (pl_compile(je_file, root, &src_st, blob_path) < 0) return -1;
+
+	return pl_map(blob_path, root, &src_st, out_layer);
+}
+
+/*
+ * a slot only answers for the cwd it was written for and only while
+ * the mtime of cwd is unchanged. A .je added between cwd and a cached
+ * root is not noticed until cwd changes, a removed one makes PL_open
+ * fail and the caller walks again with force_walk
+ */
+char *PL_find_root(const char *cache_dir, int force_walk) {
+
+	char cwd[PL_LINE_SIZE];
+	struct stat st;
+	if (getcwd(cwd, sizeof(cwd)) == NULL || stat(cwd, &st) < 0) return NULL;
+
+	char roots_path[PL_LINE_SIZE];
+	if (snprintf(roots_path, sizeof(roots_path), "%s/%s",
+				cache_dir, PL_ROOTS_FILE) >= (int)sizeof(roots_path)) {
+		return NULL;
+	}
+
+	off_t offset = (off_t)(pl_hash(cwd) % PL_ROOT_SLOTS) * sizeof(struct pl_root_slot);
+	struct pl_root_slot slot;
+	size_t cwd_len = strlen(cwd);
+
+	if (!force_walk) {
+		int fd = open(roots_path, O_RDONLY);
+		if (fd >= 0) {
+			ssize_t got = pread(fd, &slot, sizeof(slot), offset);
+			close(fd);
+
+			char *cached = slot.paths + cwd_len + 1;
+			if (got == (ssize_t)sizeof(slot)
+					&& cwd_len + 2 < sizeof(slot.paths)
+					&& slot.cwd_mtime_sec == PL_MTIME(&st).tv_sec
+					&& slot.cwd_mtime_nsec == PL_MTIME(&st).tv_nsec
+					&& !strcmp(slot.paths, cwd)
+					&& cached[0] != '\0'
+					&& memchr(cached, '\0', slot.paths + sizeof(slot.paths) - cached) != NULL) {
+				return strdup(cached); // caller must free
+			}
+		}
+	}
+
+	char *root = NULL;
+	char dir[PL_LINE_SIZE];
+	strcpy(dir, cwd);
+	while (root == NULL) {
+		char candidate[PL_LINE_SIZE];
+		if (snprintf(candidate, sizeof(candidate), "%s/%s",
+					strcmp(dir, "/") ? dir : "", PL_FILE_NAME) >= (int)sizeof(candidate)) {
+			return NULL;
+		}
+
+		if (access(candidate, R_OK) == 0) {
+			root = strdup(dir);
+			if (!root) return NULL;
+		} else if (!strcmp(dir, "/")) {
+			break;
+		} else {
+			char *slash = strrchr(dir, '/');
+			if (slash == dir) slash[1] = '\0';
+			else *slash = '\0';
+		}
+	}
+
+	// "no project" is never cached, a .je can show up in any
+	// ancestor (git pull, checkout) and nothing here would see it
+	if (root == NULL) return NULL;
+
+	size_t root_len = strlen(root);
+	if (cwd_len + 1 + root_len + 1 > sizeof(slot.paths)) return root; // too long to cache
+
+	memset(&slot, 0, sizeof(slot));
+	slot.cwd_mtime_sec = PL_MTIME(&st).tv_sec;
+	slot.cwd_mtime_nsec = PL_MTIME(&st).tv_nsec;
+	memcpy(slot.paths, cwd, cwd_len + 1);
+	memcpy(slot.paths + cwd_len + 1, root, root_len + 1);
+
+	// one slot sized pwrite, concurrent je's at worst overwrite
+	// each other's answer and the loser walks again next time
+	mkdir(cache_dir, 0700);
+	int fd = open(roots_path, O_WRONLY | O_CREAT, 0600);
+	if (fd >= 0) {
+		ssize_t written = pwrite(fd, &slot, sizeof(slot), offset);
+		close(fd);
+		// only a cache, drop it rather than keep a torn slot
+		if (written != (ssize_t)sizeof(slot)) unlink(roots_path);
+	}
+
+	return root; // caller must free
+}
+
+void PL_close(struct pl_layer *layer) {
+	BF_unmap(layer->map, layer->size);
+	memset(layer, 0, sizeof(*layer));
+}
+
+int PL_find(struct pl_layer *layer, const char *label, const char **out_path, const char **out_dir) {
+
+	size_t lo = 0, hi = layer->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = strcmp(label, layer->strings + layer->entries[mid].label);
+		if (cmp == 0) {
+			if (out_path) *out_path = layer->strings + layer->entries[mid].path;
+			if (out_dir) *out_dir = layer->strings + layer->entries[mid].dir;
+			return 1;
+		}
+		if (cmp < 0) hi = mid;
+		else lo = mid + 1;
+	}
+	return 0;
+}
+
+size_t PL_lower_bound(struct pl_layer *layer, const char *label) {
+	size_t lo = 0, hi = layer->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (strcmp(layer->strings + layer->entries[mid].label, label) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+void PL_get(struct pl_layer *layer, size_t element,
+		const char **out_label, const char **out_path, const char **out_dir) {
+	const struct pl_entry *entry = &layer->entries[element];
+	if (out_label) *out_label = layer->strings + entry->label;
+	if (out_path) *out_path = layer->strings + entry->path;
+	if (out_dir) *out_dir = layer->strings + entry->dir;
+}
+
+size_t PL_len(struct pl_layer *layer) {
+	return layer->count;
+}
@@ -0,0 +1,192 @@
+/**
+ * Usage and latency statistics for je
+ *
+ * Every invocation bumps counters in a small mmap'd file. Updates
+ * are relaxed atomic adds on the shared mapping, so recording never
+ * takes the gdbm lock and concurrent je processes never lose counts.
+ * Latencies go into fixed power of two buckets which keeps the file
+ * the same size forever and still gives usable p50 and p99
+ */
+
+#include "../include/stats.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ST_MAGIC "JES1"
+#define ST_VERSION 2
+
+static const char *st_phase_names[ST_N_PHASES] = { "lock", "command", "total" };
+
+int ST_open(const char *path, struct st_stats *out_stats) {
+
+	out_stats->file = NULL;
+
+	int fd = open(path, O_RDWR | O_CREAT, 0600);
+	if (fd < 0) return -1;
+
+	// a fresh file is all zeros which is an empty stats file
+	struct stat st;
+	if (fstat(fd, &st) < 0 ||
+			((size_t)st.st_size < sizeof(struct st_file) &&
+			 ftruncate(fd, sizeof(struct st_file)) < 0)) {
+		close(fd);
+		return -1;
+	}
+
+	void *map = mmap(NULL, sizeof(struct st_file), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return -1;
+
+	struct st_file *file = map;
+	if (memcmp(file->magic, ST_MAGIC, 4) || file->version != ST_VERSION) {
+		memset(file, 0, sizeof(struct st_file));
+		file->version = ST_VERSION;
+		memcpy(file->magic, ST_MAGIC, 4);
+	}
+
+	out_stats->file = file;
+	return 0;
+}
+
+void ST_close(struct st_stats *stats) {
+	if (stats->file) munmap(stats->file, sizeof(struct st_file));
+	stats->file = NULL;
+}
+
+uint64_t ST_now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void ST_count_cmd(struct st_stats *stats, size_t cmd, int failed) {
+	if (stats->file == NULL || cmd >= ST_MAX_CMDS) return;
+	__atomic_fetch_add(&stats->file->cmd_count[cmd], 1, __ATOMIC_RELAXED);
+	if (failed) __atomic_fetch_add(&stats->file->cmd_failed[cmd], 1, __ATOMIC_RELAXED);
+}
+
+void ST_record(struct st_stats *stats, St_phase phase, uint64_t elapsed_us) {
+
+	if (stats->file == NULL) return;
+
+	size_t bucket = 0;
+	while (bucket < ST_BUCKETS - 1 && elapsed_us >= (1ULL << bucket)) bucket++;
+
+	struct st_histogram *histogram = &stats->file->phase[phase];
+	__atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&histogram->sum_us, elapsed_us, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&histogram->bucket[bucket], 1, __ATOMIC_RELAXED);
+
+	uint64_t max = __atomic_load_n(&histogram->max_us, __ATOMIC_RELAXED);
+	while (elapsed_us > max && !__atomic_compare_exchange_n(&histogram->max_us, &max,
+				elapsed_us, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+uint64_t ST_percentile(struct st_histogram *histogram, double percent) {
+
+	if (histogram->count == 0) return 0;
+
+	// rank of the sample, rounded up so p99 of 4 samples is the 4th
+	uint64_t target = (uint64_t)(histogram->count * percent / 100.0 + 0.999999);
+	if (target == 0) target = 1;
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < ST_BUCKETS; i++) {
+		seen += histogram->bucket[i];
+		if (seen >= target) {
+			// upper edge of the bucket, never more than the real max
+			uint64_t edge = 1ULL << i;
+			return edge < histogram->max_us ? edge : histogram->max_us;
+		}
+	}
+	return histogram->max_us;
+}
+
+void ST_print(FILE *stream, struct st_stats *stats, const char **cmd_names, size_t n_cmds,
+		struct st_store *store, int json) {
+
+	// a snapshot so the numbers agree with each other
+	struct st_file snap;
+	if (stats->file) memcpy(&snap, stats->file, sizeof(snap));
+	else memset(&snap, 0, sizeof(snap));
+
+	if (n_cmds > ST_MAX_CMDS) n_cmds = ST_MAX_CMDS;
+
+	double fragmentation = store->file_size
+		? 100.0 * (1.0 - (double)store->live_bytes / store->file_size) : 0.0;
+	double load = store->buckets ? (double)store->records / store->buckets : 0.0;
+
+	if (json) {
+
+		fprintf(stream, "{\"commands\":{");
+		for (size_t i = 0; i < n_cmds; i++) {
+			fprintf(stream, "%s\"%s\":%llu", i ? "," : "", cmd_names[i],
+					(unsigned long long)snap.cmd_count[i]);
+		}
+
+		fprintf(stream, "},\"failed\":{");
+		for (size_t i = 0; i < n_cmds; i++) {
+			fprintf(stream, "%s\"%s\":%llu", i ? "," : "", cmd_names[i],
+					(unsigned long long)snap.cmd_failed[i]);
+		}
+
+		fprintf(stream, "},\"latency_us\":{");
+		for (size_t i = 0; i < ST_N_PHASES; i++) {
+			struct st_histogram *h = &snap.phase[i];
+			fprintf(stream, "%s\"%s\":{\"count\":%llu,\"mean\":%llu,\"p50\":%llu,\"p99\":%llu,"
+					"\"max\":%llu,\"buckets\":[", i ? "," : "", st_phase_names[i],
+					(unsigned long long)h->count,
+					(unsigned long long)(h->count ? h->sum_us / h->count : 0),
+					(unsigned long long)ST_percentile(h, 50),
+					(unsigned long long)ST_percentile(h, 99),
+					(unsigned long long)h->max_us);
+			for (size_t b = 0; b < ST_BUCKETS; b++) {
+				fprintf(stream, "%s%llu", b ? "," : "", (unsigned long long)h->bucket[b]);
+			}
+			fprintf(stream, "]}");
+		}
+
+		fprintf(stream, "},\"store\":{\"file_bytes\":%llu,\"live_bytes\":%llu,"
+				"\"fragmentation_pct\":%.1f,\"records\":%llu,\"labels\":%llu,"
+				"\"buckets\":%llu,\"bucket_load\":%.2f}}\n",
+				(unsigned long long)store->file_size, (unsigned long long)store->live_bytes,
+				fragmentation, (unsigned long long)store->records,
+				(unsigned long long)store->labels, (unsigned long long)store->buckets, load);
+		return;
+	}
+
+	fprintf(stream, "Commands\n");
+	for (size_t i = 0; i < n_cmds; i++) {
+		fprintf(stream, "   %-18s %llu", cmd_names[i], (unsigned long long)snap.cmd_count[i]);
+		if (snap.cmd_failed[i]) {
+			fprintf(stream, " (%llu failed)", (unsigned long long)snap.cmd_failed[i]);
+		}
+		fprintf(stream, "\n");
+	}
+
+	fprintf(stream, "\nLatency (us)         count      mean       p50       p99       max\n");
+	for (size_t i = 0; i < ST_N_PHASES; i++) {
+		struct st_histogram *h = &snap.phase[i];
+		fprintf(stream, "   %-12s %9llu %9llu %9llu %9llu %9llu\n", st_phase_names[i],
+				(unsigned long long)h->count,
+				(unsigned long long)(h->count ? h->sum_us / h->count : 0),
+				(unsigned long long)ST_percentile(h, 50),
+				(unsigned long long)ST_percentile(h, 99),
+				(unsigned long long)h->max_us);
+	}
+
+	fprintf(stream, "\nStore\n");
+	fprintf(stream, "   file size ........ %llu bytes\n", (unsigned long long)store->file_size);
+	fprintf(stream, "   live data ........ %llu bytes (%.1f%% free or overhead)\n",
+			(unsigned long long)store->live_bytes, fragmentation);
+	fprintf(stream, "   records .......... %llu (%llu labels)\n",
+			(unsigned long long)store->records, (unsigned long long)store->labels);
+	if (store->buckets) {
+		fprintf(stream, "   hash buckets ..... %llu (%.2f records per bucket)\n",
+				(unsigned long long)store->buckets, load);
+	}
+}